@@ -0,0 +1,377 @@
+// rubik_bench：热点路径的微基准
+// 每个用例先预热，再采若干个样本（每个样本内循环若干次，自动校准到约 2ms），
+// 统计每次操作的耗时（ns/op）：最小值、中位数、平均值、p99、标准差。
+// 人读的表格写到标准错误，机器可读的 JSON 写到标准输出或 --json 指定的文件，便于比较不同构建。
+//
+// 用法：rubik_bench [--filter 子串] [--samples N] [--json 文件] [--no-solve]
+#include "cube.h"
+#include "cube_batch.h"
+#include "cube_n.h"
+#include "moves.h"
+#include "optimal_solver.h"
+#include "scrambler.h"
+#include "solver.h"
+#include "state_validator.h"
+#include "symmetry.h"
+#include "table_cache.h"
+#include "min2phase/min2phase.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 阻止编译器把基准循环里的结果优化掉
+template <class T>
+inline void keep(T &&value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct Stats {
+    std::string name;
+    size_t samples;
+    size_t itersPerSample;
+    double minNs, medianNs, meanNs, p99Ns, stddevNs;
+};
+
+struct Options {
+    const char *filter = nullptr;
+    size_t samples = 30;
+    const char *json = nullptr;
+    bool solve = true;
+};
+
+std::vector<Stats> results;
+
+// body(n) 执行 n 次被测操作；返回值为本样本的总耗时（纳秒）
+using Body = std::function<double(size_t)>;
+
+double timeLoop(const std::function<void()> &op, size_t n)
+{
+    Clock::time_point t0 = Clock::now();
+    for (size_t i = 0; i < n; ++i)
+        op();
+    return std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+}
+
+void record(const std::string &name, std::vector<double> perOp, size_t iters)
+{
+    std::sort(perOp.begin(), perOp.end());
+    Stats s;
+    s.name = name;
+    s.samples = perOp.size();
+    s.itersPerSample = iters;
+    s.minNs = perOp.front();
+    s.medianNs = perOp[perOp.size() / 2];
+    s.p99Ns = perOp[(size_t)(0.99 * (double)(perOp.size() - 1) + 0.5)];
+    double sum = 0, sq = 0;
+    for (double v : perOp)
+        sum += v;
+    s.meanNs = sum / (double)perOp.size();
+    for (double v : perOp)
+        sq += (v - s.meanNs) * (v - s.meanNs);
+    s.stddevNs = std::sqrt(sq / (double)perOp.size());
+    results.push_back(s);
+    fprintf(stderr, "%-28s %12.2f %12.2f %12.2f %12.2f  (%zu x %zu)\n", name.c_str(), s.minNs, s.medianNs, s.meanNs,
+            s.p99Ns, s.samples, iters);
+}
+
+bool selected(const Options &opt, const char *name)
+{
+    return !opt.filter || strstr(name, opt.filter) != nullptr;
+}
+
+// 常规用例：自动校准内循环次数，使每个样本约 2ms
+void bench(const Options &opt, const char *name, const std::function<void()> &op)
+{
+    if (!selected(opt, name))
+        return;
+    size_t iters = 1;
+    while (iters < (1u << 30))
+    {
+        double ns = timeLoop(op, iters);
+        if (ns > 2e6)
+            break;
+        iters *= ns < 2e5 ? 10 : 2;
+    }
+    for (int w = 0; w < 3; ++w)
+        timeLoop(op, iters);
+    std::vector<double> perOp;
+    for (size_t s = 0; s < opt.samples; ++s)
+        perOp.push_back(timeLoop(op, iters) / (double)iters);
+    record(name, perOp, iters);
+}
+
+// 只能跑一次的用例（冷启动）：直接记录单个样本
+void benchOnce(const Options &opt, const char *name, const std::function<void()> &op)
+{
+    if (!selected(opt, name))
+        return;
+    record(name, {timeLoop(op, 1)}, 1);
+}
+
+void writeJson(FILE *f)
+{
+    fprintf(f, "{\n  \"unit\": \"ns/op\",\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Stats &s = results[i];
+        fprintf(f,
+                "    {\"name\": \"%s\", \"samples\": %zu, \"iterations\": %zu, \"min\": %.3f, \"median\": %.3f, "
+                "\"mean\": %.3f, \"p99\": %.3f, \"stddev\": %.3f}%s\n",
+                s.name.c_str(), s.samples, s.itersPerSample, s.minNs, s.medianNs, s.meanNs, s.p99Ns, s.stddevNs,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+bool parseArgs(int argc, char **argv, Options &opt)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(a, "--filter") && hasValue)
+            opt.filter = argv[++i];
+        else if (!strcmp(a, "--samples") && hasValue)
+            opt.samples = (size_t)std::max(1, atoi(argv[++i]));
+        else if (!strcmp(a, "--json") && hasValue)
+            opt.json = argv[++i];
+        else if (!strcmp(a, "--no-solve"))
+            opt.solve = false;
+        else
+            return false;
+    }
+    return true;
+}
+
+// 固定种子的随机状态，保证不同构建之间测的是同一批魔方
+std::vector<Cube> randomCubes(size_t n, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<Cube> cubes(n);
+    for (Cube &c : cubes)
+        for (int i = 0; i < 30; ++i)
+            c.applyMove((MoveId)(rng() % MoveFaceCount));
+    return cubes;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    if (!parseArgs(argc, argv, opt))
+    {
+        fprintf(stderr, "usage: rubik_bench [--filter SUBSTR] [--samples N] [--json FILE] [--no-solve]\n");
+        return 2;
+    }
+    fprintf(stderr, "%-28s %12s %12s %12s %12s\n", "benchmark (ns/op)", "min", "median", "mean", "p99");
+
+    // --- 魔方状态与转动 ---
+    Cube cube;
+    std::vector<Cube> cubes = randomCubes(64, 1);
+    const char *axisNames[3] = {"cube.rotateLayer.x", "cube.rotateLayer.y", "cube.rotateLayer.z"};
+    for (int a = 0; a < 3; ++a)
+    {
+        int layer = 0;
+        bench(opt, axisNames[a], [&] {
+            cube.rotateLayer((Axis)a, layer, true);
+            layer = layer == 2 ? 0 : layer + 1;
+            keep(cube);
+        });
+    }
+    {
+        // 按面存放贴纸的 N 阶魔方：外层（含整面旋转）与内层各测一次
+        CubeN<3> c3;
+        CubeN<7> c7;
+        CubeN<17> c17;
+        int a = 0;
+        bench(opt, "cubeN<3>.rotateLayer", [&] {
+            c3.rotateLayer((Axis)a, 2, true);
+            a = a == 2 ? 0 : a + 1;
+            keep(c3);
+        });
+        bench(opt, "cubeN<7>.rotateLayer", [&] {
+            c7.rotateLayer((Axis)a, a * 3, true);
+            a = a == 2 ? 0 : a + 1;
+            keep(c7);
+        });
+        bench(opt, "cubeN<17>.rotateLayer.outer", [&] {
+            c17.rotateLayer((Axis)a, 16, true);
+            a = a == 2 ? 0 : a + 1;
+            keep(c17);
+        });
+        bench(opt, "cubeN<17>.rotateLayer.inner", [&] {
+            c17.rotateLayer((Axis)a, 8, true);
+            a = a == 2 ? 0 : a + 1;
+            keep(c17);
+        });
+    }
+    {
+        size_t i = 0;
+        bench(opt, "cube.copy", [&] {
+            Cube copy = cubes[i++ & 63];
+            keep(copy);
+        });
+    }
+    {
+        std::vector<MoveId> seq(20);
+        std::mt19937 rng(2);
+        for (MoveId &m : seq)
+            m = (MoveId)(rng() % MoveFaceCount);
+        bench(opt, "cube.applySequence.20", [&] {
+            cube.applySequence(seq);
+            keep(cube);
+        });
+    }
+    {
+        // 状态哈希与对称约化
+        size_t i = 0;
+        bench(opt, "zobrist.hash", [&] {
+            uint64_t h = zobristHash(cubes[i++ & 63].state());
+            keep(h);
+        });
+        bench(opt, "symmetry.canonicalState", [&] {
+            CubieState c = canonicalState(cubes[i++ & 63].state());
+            keep(c);
+        });
+    }
+    {
+        CubeBatch batch(4096);
+        int m = 0;
+        bench(opt, "batch.applyMove.4096", [&] {
+            batch.applyMove((MoveId)m);
+            m = m + 1 == MoveFaceCount ? 0 : m + 1;
+        });
+    }
+
+    // --- 打乱与编码 ---
+    bench(opt, "scrambler.generateScramble.20", [&] {
+        auto s = generateScramble(20);
+        keep(s);
+    });
+    {
+        ScrambleRng rng(4);
+        bench(opt, "scrambler.randomCubieState", [&] {
+            CubieState s = randomCubieState(rng);
+            keep(s);
+        });
+    }
+    {
+        size_t i = 0;
+        bench(opt, "solver.encodeFacelets", [&] {
+            std::string f = Solver::encodeFacelets(cubes[i++ & 63]);
+            keep(f);
+        });
+    }
+    {
+        size_t i = 0;
+        std::array<char, 54> out;
+        bench(opt, "solver.encodeFacelets.array", [&] {
+            Solver::encodeFacelets(cubes[i++ & 63], out);
+            keep(out);
+        });
+        std::vector<Cube> tracked = cubes;
+        for (Cube &c : tracked)
+            c.setTrackFacelets(true);
+        bench(opt, "solver.encodeFacelets.tracked", [&] {
+            Solver::encodeFacelets(tracked[i++ & 63], out);
+            keep(out);
+        });
+        Cube t;
+        t.setTrackFacelets(true);
+        bench(opt, "cube.rotateLayer.tracked", [&] {
+            t.rotateLayer(AxisX, 2, true);
+            keep(t);
+        });
+    }
+    {
+        // 求解前的合法性检查
+        std::vector<std::string> facelets;
+        for (const Cube &c : cubes)
+            facelets.push_back(Solver::encodeFacelets(c));
+        size_t i = 0;
+        bench(opt, "validator.validateFacelets", [&] {
+            StateError e = validateFacelets(facelets[i++ & 63]);
+            keep(e);
+        });
+        bench(opt, "validator.validateState", [&] {
+            StateError e = validateState(cubes[i++ & 63].state());
+            keep(e);
+        });
+    }
+    {
+        const std::string sol = "D2 R' D' F2 B D R2 D2 R' F2 D' F2 U' B2 L2 U2 D R2 U (19f)";
+        bench(opt, "solver.parseSolution", [&] {
+            auto cmds = Solver::toCommands(Solver::parseSolution(sol));
+            keep(cmds);
+        });
+    }
+    {
+        std::vector<RotationCommand> raw(20);
+        std::mt19937 rng(3);
+        for (RotationCommand &c : raw)
+            c = {(Axis)(rng() % 3), (int)(rng() % 2) * 2, rng() % 2 == 0};
+        bench(opt, "scramble.simplify.20", [&] {
+            auto out = simplifyScramble(raw);
+            keep(out);
+        });
+    }
+
+    // --- min2phase 求解：冷启动（建表 / 读缓存）与热求解 ---
+    if (opt.solve)
+    {
+        benchOnce(opt, "min2phase.init.cold", [] { min2phase::init(); });
+        benchOnce(opt, "tablecache.ensureReady", [] { TableCache::ensureReady(); });
+        std::vector<std::string> facelets;
+        for (const Cube &c : randomCubes(16, 3))
+            facelets.push_back(Solver::encodeFacelets(c));
+        size_t i = 0;
+        bench(opt, "min2phase.solve.warm", [&] {
+            std::string s = Solver::solveFacelets(facelets[i++ & 15]);
+            keep(s);
+        });
+
+        // 最优求解：模式数据库加载（没有缓存时为生成）、启发函数、一个 10 步打乱的完整搜索
+        benchOnce(opt, "optimal.ensureReady", [] { OptimalSolver::ensureReady(); });
+        std::vector<Cube> deep = randomCubes(64, 5);
+        bench(opt, "optimal.lowerBound", [&] {
+            int h = OptimalSolver::lowerBound(deep[i++ & 63].state());
+            keep(h);
+        });
+        Cube ten;
+        std::mt19937 rng(6);
+        for (int k = 0; k < 10; ++k)
+            ten.applyMove((MoveId)(rng() % MoveFaceCount));
+        bench(opt, "optimal.solve.10", [&] {
+            OptimalResult r = OptimalSolver::solve(ten.state(), 0, 1);
+            keep(r);
+        });
+    }
+
+    if (opt.json)
+    {
+        FILE *f = fopen(opt.json, "w");
+        if (!f)
+        {
+            fprintf(stderr, "rubik_bench: cannot write %s\n", opt.json);
+            return 1;
+        }
+        writeJson(f);
+        fclose(f);
+    }
+    else
+        writeJson(stdout);
+    return 0;
+}
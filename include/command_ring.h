@@ -0,0 +1,59 @@
+#pragma once
+#include "cube.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// 转动指令的来源
+enum CommandSource : uint8_t {
+    SourceUser = 0,   // 键盘 J/K
+    SourceScramble,   // 打乱
+    SourceSolver,     // 求解结果
+    SourceScript,     // 脚本 / 回放
+    SourceCount
+};
+
+// 一条 90° 转动指令（clockwise 为动画角度方向，与 RotationCommand 相同）
+struct MoveCommand {
+    Axis axis;
+    int8_t layer;
+    bool clockwise;
+    CommandSource source;
+};
+
+// 有界多生产者 / 单消费者无锁环形队列：任意线程 push，只有主线程（Controller::update）pop
+// 每个槽带一个序号：序号 == 位置 表示空闲可写，== 位置 + 1 表示已写好可读；
+// 生产者用 CAS 抢占写位置，消费者按顺序读，所以不需要锁
+class CommandRing {
+public:
+    explicit CommandRing(size_t capacity = 1024);  // 向上取整到 2 的幂
+
+    CommandRing(const CommandRing &) = delete;
+    CommandRing &operator=(const CommandRing &) = delete;
+
+    // 任意线程：写入一条 / 连续写入 n 条（要么全部写入、要么都不写，不会与其它生产者交错），队列满时返回 false
+    bool push(const MoveCommand &cmd);
+    bool pushBatch(const MoveCommand *cmds, size_t n);
+
+    // 仅消费者线程：取出最早的一条，队列空（或最早的一条还没写完）时返回 false
+    bool pop(MoveCommand &cmd);
+
+    // 近似值：并发写入时可能包含尚未写完的指令
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+    // 某个来源尚未取走的指令数
+    size_t pending(CommandSource source) const;
+    size_t capacity() const { return mask + 1; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq;
+        MoveCommand cmd;
+    };
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> tail;  // 下一个写位置（生产者共享）
+    alignas(64) std::atomic<size_t> head;  // 下一个读位置（只有消费者写）
+    alignas(64) std::atomic<uint32_t> pendingCount[SourceCount];
+};
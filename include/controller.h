@@ -1,20 +1,45 @@
 #pragma once
 #include "cube.h"
+#include "command_ring.h"
+#include "input.h"
 #include "scrambler.h"
 #include "solver.h"
+#include "solver_worker.h"
+
+class MoveLogWriter;
 
 // 控制器类：处理用户输入和动画状态
 class Controller {
 public:
     Controller();
-    // 更新输入和状态，参数为魔方引用（以便触发旋转更新）
-    void update(Cube& cube);
+    // 更新输入和状态，参数为魔方引用（以便触发旋转更新）、本帧的输入源和距上一帧的秒数
+    // 动画与摄像机都按 dt 推进，速度与帧率无关
+    void update(Cube& cube, const InputSource& input, float dt);
+    // 没有动画、没有待执行的打乱/求解指令、后台也没有在求解
+    bool isIdle() const;
+
+    // 动画速度：每秒完成的 90° 转动数；easing 为 true 时角度按 smoothstep 先加速后减速
+    void setTurnsPerSecond(float tps);
+    float getTurnsPerSecond() const { return turnsPerSecond; }
+    void setEasing(bool on) { easing = on; }
+    // 快进：待播放的转动（指令队列加上 anytime 求解还没送出的部分）按当前速度放完要超过 maxSeconds 秒时，
+    // 直接应用多出来的转动，只播放最后 maxSeconds 秒能放完的部分（至少一条）；对所有来源一视同仁。<= 0 关闭（默认）
+    void setFastForward(float maxSeconds);
+    // 按 U 时使用的求解引擎与时间预算（见 Solver::solve，<= 0 为引擎默认值）
+    void setSolverEngine(SolverEngine engine, double budgetSeconds);
+    // 转动指令队列：任意线程都可以 push（打乱、求解、脚本、回放），update 中统一取出播放
+    CommandRing& getCommands() { return commands; }
+    const CommandRing& getCommands() const { return commands; }
+    // 转动日志：设置后每个作用到魔方上的转动都会被记录（不转移所有权，nullptr 关闭）
+    void setMoveLog(MoveLogWriter* log) { moveLog = log; }
     
     // 摄像机相关的只读获取，用于渲染
     float getCameraYaw() const   { return cameraYaw; }
     float getCameraPitch() const { return cameraPitch; }
     float getCameraDistance() const { return cameraDistance; }
     
+    // 每个轴上的层数（即 Cube::kLayerCount），层选择与整体翻转都按它循环
+    int   getLayerCount() const { return Cube::kLayerCount; }
     // 当前选择的轴和层
     Axis  getSelectedAxis() const  { return selectedAxis; }
     int   getSelectedLayer() const { return selectedLayer; }
@@ -30,8 +55,21 @@ public:
     bool getIsScrambling() const { return isScrambling; }
     bool getIsSolving() const { return isSolving; }
     bool getIsTurning() const { return isTurning; }
+    bool getShowProfiler() const { return showProfiler; }
 
 private:
+    void cancelSolve();
+    void selectAxis(Axis axis);
+    void applyCommand(Cube& cube, Axis axis, int layer, bool clockwise, CommandSource source);
+    void startRotation(Axis axis, int layer, bool clockwise);
+    void startNextCommand(Cube& cube);
+    bool pushScramble(const std::vector<RotationCommand>& scramble);
+    bool pushSolution(const std::vector<RotationCommandSolver>& solution);
+    void acceptSolveUpdate(const Cube& cube, const std::vector<MoveId>& moves, const Cube& snapshot);
+    void feedSolve();
+    void advanceRotation(Cube& cube, float dt);
+    size_t fastForwardCount(size_t queued) const;
+
     // 摄像机绕魔方的角度和距离
     float cameraYaw;
     float cameraPitch;
@@ -45,9 +83,26 @@ private:
     int   rotLayer;
     bool  rotClockwise;
     float currentAngle;    // 当前已旋转的角度 (度数)
-    float rotationSpeed;   // 每帧旋转速度 (度)
+    float rotProgress;     // 动画进度 0..1（按时间线性增长）
+    float turnsPerSecond;  // 每秒 90° 转动数
+    bool  easing;
+    float fastForwardSeconds;  // 队列播放时间上限，<= 0 为不快进
     bool isHighlight; // 是否显示选中层高亮
     bool isScrambling;
+    bool awaitingScramble;  // 已请求后台生成随机状态打乱，结果还没到
     bool isSolving;
     bool isTurning;
+    bool showProfiler; // 是否显示帧耗时叠加层（F1）
+    CommandRing commands;
+    CommandSource rotSource;  // 当前动画指令的来源
+    double clockSeconds;      // update 累计的时间（日志时间戳）
+    MoveLogWriter* moveLog;
+    SolverEngine solverEngine;
+    double solverBudget;
+    // anytime 求解的播放进度：solvePlayed 为已送入指令队列的步，solveTail 为剩余的步（可被更短的尾巴替换）
+    bool streamingSolve;
+    std::vector<MoveId> solvePlayed;
+    std::vector<MoveId> solveTail;
+    // 后台求解线程：按 U 时提交快照，结果回来后再送入 commands
+    SolverWorker solver;
 };
@@ -1,6 +1,10 @@
 #pragma once
 #include <raylib.h>  // 使用 Raylib 的 Color 结构定义颜色
 #include <array>
+#include <tuple>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 // 魔方面索引的枚举，方便引用
 enum Face { LEFT = 0, RIGHT = 1, DOWN = 2, UP = 3, BACK = 4, FRONT = 5 };
@@ -12,33 +16,82 @@ inline bool operator<(const Color& a, const Color& b) {
     return std::tie(a.r, a.g, a.b, a.a) < std::tie(b.r, b.g, b.b, b.a);
 }
 
-// 表示一个小立方体（魔方的小块）
+// 表示一个小立方体（魔方的小块）的贴纸视图，由 Cube 按位置即时生成
 struct CubePiece {
     // 每个面一个颜色（如果该面没有贴纸，则设为透明NONE）
     Color faceColor[6];
-    
-    // 旋转此小方块的朝向颜色（更新贴纸面对应关系）
-    void rotateAroundX(bool clockwise);
-    void rotateAroundY(bool clockwise);
-    void rotateAroundZ(bool clockwise);
 };
 
-// 3x3x3 魔方类，包含27个小立方块
+// 小块级魔方状态：只记录“哪个块在哪个槽位、朝向如何”，共 32 字节
+// 字节布局（低 16 字节 / 高 16 字节各自独立，便于按 128 位通道整体置换）：
+//   [0,8)   角块：块编号(0..7) + 朝向(0..2) * 8
+//   [8,14)  中心块：块编号(0..5)，中层转动会移动中心块
+//   [16,28) 棱块：块编号(0..11) + 朝向(0..1) * 16
+//   其余字节为填充，恒为 0
+struct CubieState {
+    static constexpr int kCornerOffset = 0;
+    static constexpr int kCenterOffset = 8;
+    static constexpr int kEdgeOffset = 16;
+
+    alignas(32) uint8_t b[32];
+
+    bool operator==(const CubieState& o) const;
+    bool operator!=(const CubieState& o) const { return !(*this == o); }
+};
+
+// 54 个贴纸的数组（min2phase 的 URFDLB 顺序），补齐到 64 字节以便整体置换
+struct FaceletState {
+    alignas(64) uint8_t f[64];
+};
+
+enum MoveId : uint8_t; // 见 moves.h
+
+// 3x3x3 魔方类：内部只保存 CubieState，贴纸颜色由状态推导
 class Cube {
 public:
-    Cube();  // 构造初始化魔方（6面颜色初始化为标准配色）
-    
+    static constexpr int kLayerCount = 3;  // 每个轴上的层数
+
+    Cube();  // 构造初始化魔方（复原状态）
+
     // 旋转给定轴上某一层（layerIndex=0底/左/背,1中间,2顶/右/前），direction=true顺时针
     void rotateLayer(Axis axis, int layerIndex, bool clockwise);
-    
-    // 获取小方块指针，供渲染使用
-    CubePiece* getPiece(int x, int y, int z) const { return grid[x][y][z]; }
+    // 按标准记号执行一个转动 / 一串转动（见 moves.h）
+    void applyMove(MoveId move);
+    void applySequence(const MoveId *moves, size_t count);
+    void applySequence(const std::vector<MoveId> &moves) { applySequence(moves.data(), moves.size()); }
+
+    // 获取位置 (x,y,z) 上小块的贴纸视图，供渲染使用
+    CubePiece getPiece(int x, int y, int z) const;
+    // 位置 (x,y,z) 的 face 面上贴纸的颜色（无贴纸返回透明色）
+    Color faceColor(int x, int y, int z, Face face) const;
+    // 位置 (x,y,z) 的 face 面上贴纸原本所属的面（即贴纸身份），无贴纸返回 -1
+    int stickerHome(int x, int y, int z, Face face) const;
+
+    // 某个面（复原状态下）的贴纸颜色
+    static Color homeColor(Face face);
+
+    // 每个面 9 个贴纸同色即为复原（与整体朝向无关）
+    bool isSolved() const;
+
+    const CubieState& state() const { return cubies; }
+    void setState(const CubieState& s);
+    // 状态的 64 位 Zobrist 哈希（见 symmetry.h），每次转动增量维护，读取为 O(1)
+    uint64_t hash() const { return zobrist; }
+    bool operator==(const Cube& o) const { return zobrist == o.zobrist && cubies == o.cubies; }
+    bool operator!=(const Cube& o) const { return cubies != o.cubies; }
+
+    // 贴纸跟踪：开启后每次转动同时置换一份 54 字节的 facelet 字母数组（每个贴纸原本所属面的字母），
+    // 编码 facelet 字符串时只需拷贝，适合大量编码的场景
+    void setTrackFacelets(bool enable);
+    bool tracksFacelets() const { return trackFacelets; }
+    // 跟踪中的 facelet 字母数组（未开启跟踪时为 nullptr）
+    const FaceletState* facelets() const { return trackFacelets ? &letters : nullptr; }
 
 private:
-    // 27个小方块的实际存储和3D映射（使用指针方便交换）
-    CubePiece pieces[27];
-    CubePiece* grid[3][3][3];
-    
-    // 帮助函数：将某二维平面3x3的九个指针按照顺/逆时针旋转90度
-    void rotateFacePointers(Axis axis, int layerIndex, bool clockwise);
+    void syncFacelets();
+
+    CubieState cubies;
+    uint64_t zobrist;
+    bool trackFacelets;
+    FaceletState letters;
 };
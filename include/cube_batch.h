@@ -0,0 +1,50 @@
+#pragma once
+#include "cube.h"
+#include "moves.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// 批量魔方：N 个 CubieState 按“字节平面”存放（结构体数组 -> 数组结构体）
+// plane(i)[lane] 即第 lane 个魔方的 state.b[i]，每个平面按 32 字节对齐、长度补齐到 32 的倍数，
+// 同一转动作用于所有魔方时只需对被转动的十来个平面做整块加载/相加/存储（AVX2 一次 32 个魔方）
+class CubeBatch {
+public:
+    static constexpr size_t kLaneBlock = 32;
+
+    explicit CubeBatch(size_t count = 0);  // count 个复原状态的魔方
+
+    size_t size() const { return count; }
+    void resize(size_t count);     // 新增的魔方为复原状态
+    void reset();                  // 全部恢复为复原状态
+
+    // 单个魔方的读写（与 Cube 互相转换）
+    CubieState get(size_t lane) const;
+    void set(size_t lane, const CubieState &state);
+    Cube cube(size_t lane) const;
+    void set(size_t lane, const Cube &cube) { set(lane, cube.state()); }
+
+    // 所有魔方执行同一个转动 / 同一串转动
+    void applyMove(MoveId move);
+    void applySequence(const MoveId *moves, size_t count);
+    void applySequence(const std::vector<MoveId> &moves) { applySequence(moves.data(), moves.size()); }
+    // 每个魔方各执行一个转动：moves[lane]
+    void applyMoves(const MoveId *moves);
+
+    // 批量编码为 min2phase 的 facelet 字符串：out[lane * 54 + i]，不含结尾 '\0'
+    void encodeFacelets(char *out) const;
+    // 批量判断是否复原（每个面 9 个贴纸同色，与整体朝向无关）：solved[lane] 为 0/1，返回复原的个数
+    size_t solvedMask(uint8_t *solved) const;
+
+private:
+    uint8_t *plane(int i) { return data.get() + (size_t)i * stride; }
+    const uint8_t *plane(int i) const { return data.get() + (size_t)i * stride; }
+
+    struct AlignedFree {
+        void operator()(uint8_t *p) const;
+    };
+    size_t count;
+    size_t stride;  // 每个平面的字节数（count 向上取整到 kLaneBlock）
+    std::unique_ptr<uint8_t[], AlignedFree> data;
+};
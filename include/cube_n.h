@@ -0,0 +1,174 @@
+#pragma once
+#include "cube.h"
+#include <cstdint>
+#include <cstring>
+
+// NxNxN 魔方（N = 2..17），按面存放贴纸：stickers[face][i * N + j] 为该面贴纸原本所属的面
+// 面内坐标 (i, j) 取除该面法线轴以外的两个坐标，按轴序排列：LEFT/RIGHT 为 (y, z)，DOWN/UP 为 (x, z)，BACK/FRONT 为 (x, y)
+// 转动一层只搬动 4 条各 N 个贴纸的边带，外层再加一个 N x N 面的旋转，代价为 O(N) / O(N^2)，与小块数 O(N^3) 无关；
+// N 为编译期常量，循环边界固定、可被展开；每个 (轴, 层, 方向) 的边带起点与步长预先算好，转动时不做坐标换算
+// 坐标、层号与 clockwise 的约定与 Cube::rotateLayer 相同（3x3x3 时两者结果一致），
+// 3x3x3 的求解、批量与编码仍使用小块级的 Cube；窗口与 Controller 也只处理 Cube，CubeN 目前只供 rubik_bench 与测试使用
+template <int N>
+class CubeN {
+    static_assert(N >= 2 && N <= 17, "CubeN supports 2x2x2 .. 17x17x17");
+
+public:
+    static constexpr int kSize = N;
+
+    CubeN()
+    {
+        for (int f = 0; f < 6; ++f)
+            memset(stickers[f], f, sizeof(stickers[f]));
+    }
+
+    // 旋转给定轴上的第 layer 层（0 .. N-1），clockwise 与 Cube::rotateLayer 相同
+    void rotateLayer(Axis axis, int layer, bool clockwise)
+    {
+        turn(axis, layer, clockwise);
+    }
+
+    // 位置 (x,y,z) 的 face 面上贴纸原本所属的面，该位置在这个面上没有贴纸时返回 -1
+    int stickerHome(int x, int y, int z, Face face) const
+    {
+        int c[3] = {x, y, z};
+        if (c[face / 2] != (face % 2 ? N - 1 : 0))
+            return -1;
+        return stickers[face][index(face, c)];
+    }
+    Color faceColor(int x, int y, int z, Face face) const
+    {
+        int home = stickerHome(x, y, z, face);
+        return home < 0 ? Color{0, 0, 0, 0} : Cube::homeColor((Face)home);
+    }
+
+    // 每个面的贴纸同色即为复原
+    bool isSolved() const
+    {
+        for (int f = 0; f < 6; ++f)
+            for (int k = 1; k < N * N; ++k)
+                if (stickers[f][k] != stickers[f][0])
+                    return false;
+        return true;
+    }
+
+    // 某个面的 N*N 个贴纸（按面内坐标行主序）
+    const uint8_t *face(Face f) const { return stickers[f]; }
+
+    bool operator==(const CubeN &o) const { return memcmp(stickers, o.stickers, sizeof(stickers)) == 0; }
+    bool operator!=(const CubeN &o) const { return !(*this == o); }
+
+private:
+    // 面内下标：除法线轴以外的两个坐标按轴序排列
+    static int index(int face, const int c[3])
+    {
+        int a = face / 2;
+        int i = a == AxisX ? c[1] : c[0];
+        int j = a == AxisZ ? c[1] : c[2];
+        return i * N + j;
+    }
+
+    // 一次层转动的搬运计划：4 条边带在源面 / 目标面上的起点与步长（面内下标对边带序号 t 是线性的）
+    struct StripPlan {
+        uint8_t fromFace[4], toFace[4];
+        int16_t src[4], srcStep[4], dst[4], dstStep[4];
+    };
+
+    // 所有 (轴, 层, 方向) 的计划只算一次
+    static const StripPlan &plan(Axis axis, int layer, bool clockwise)
+    {
+        struct Plans {
+            StripPlan p[3][N][2];
+            Plans()
+            {
+                for (int a = 0; a < 3; ++a)
+                    for (int l = 0; l < N; ++l)
+                        for (int cw = 0; cw < 2; ++cw)
+                            p[a][l][cw] = build((Axis)a, l, cw != 0);
+            }
+        };
+        static const Plans plans;
+        return plans.p[axis][layer][clockwise];
+    }
+
+    static StripPlan build(Axis axis, int layer, bool clockwise)
+    {
+        // 绕轴顺时针转动时面的循环（cycle[q] 转到 cycle[q+1]），与 moves.cpp 的 kFaceCycle 相同
+        static const Face kCycle[3][4] = {
+            {FRONT, UP, BACK, DOWN},
+            {FRONT, RIGHT, BACK, LEFT},
+            {LEFT, UP, RIGHT, DOWN},
+        };
+        // 该轴之外的两个坐标 (u,v)：顺时针 (u,v)->(v,N-1-u)，逆时针 (u,v)->(N-1-v,u)
+        int U = axis == AxisX ? 1 : 0;
+        int V = axis == AxisZ ? 1 : 2;
+        StripPlan plan;
+        for (int q = 0; q < 4; ++q)
+        {
+            Face f = kCycle[axis][q];
+            Face to = kCycle[axis][(q + (clockwise ? 1 : 3)) % 4];
+            int at[2], moved[2];
+            for (int t = 0; t < 2; ++t)
+            {
+                // 第 layer 层在面 f 上的边带的第 t 个贴纸
+                int c[3];
+                int b = f / 2;
+                c[axis] = layer;
+                c[b] = f % 2 ? N - 1 : 0;
+                c[3 - axis - b] = t;
+                at[t] = index(f, c);
+                int u = c[U], v = c[V];
+                c[U] = clockwise ? v : N - 1 - v;
+                c[V] = clockwise ? N - 1 - u : u;
+                moved[t] = index(to, c);
+            }
+            plan.fromFace[q] = (uint8_t)f;
+            plan.toFace[q] = (uint8_t)to;
+            plan.src[q] = (int16_t)at[0];
+            plan.srcStep[q] = (int16_t)(at[1] - at[0]);
+            plan.dst[q] = (int16_t)moved[0];
+            plan.dstStep[q] = (int16_t)(moved[1] - moved[0]);
+        }
+        return plan;
+    }
+
+    void turn(Axis axis, int layer, bool clockwise)
+    {
+        const StripPlan &p = plan(axis, layer, clockwise);
+        // 4 条边带先整体取出，再按计划写到下一个面：内层循环只是定长的跨步拷贝
+        uint8_t strip[4][N];
+        for (int q = 0; q < 4; ++q)
+        {
+            const uint8_t *from = stickers[p.fromFace[q]] + p.src[q];
+            for (int t = 0; t < N; ++t)
+                strip[q][t] = from[t * p.srcStep[q]];
+        }
+        for (int q = 0; q < 4; ++q)
+        {
+            uint8_t *to = stickers[p.toFace[q]] + p.dst[q];
+            for (int t = 0; t < N; ++t)
+                to[t * p.dstStep[q]] = strip[q][t];
+        }
+
+        // 外层还要旋转法线沿该轴的整个面；面内坐标恰为 (u, v)
+        if (layer != 0 && layer != N - 1)
+            return;
+        uint8_t *face = stickers[axis * 2 + (layer == N - 1 ? 1 : 0)];
+        uint8_t old[N * N];
+        memcpy(old, face, sizeof(old));
+        if (clockwise)
+        {
+            for (int u = 0; u < N; ++u)
+                for (int v = 0; v < N; ++v)
+                    face[v * N + (N - 1 - u)] = old[u * N + v];
+        }
+        else
+        {
+            for (int u = 0; u < N; ++u)
+                for (int v = 0; v < N; ++v)
+                    face[(N - 1 - v) * N + u] = old[u * N + v];
+        }
+    }
+
+    alignas(64) uint8_t stickers[6][N * N];
+};
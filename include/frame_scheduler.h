@@ -0,0 +1,50 @@
+#pragma once
+#include "cube.h"
+#include "controller.h"
+#include <chrono>
+
+// 帧调度：唯一决定帧率与是否重绘的地方
+// - 有动画、待执行指令或后台求解时，按 activeFps 连续出帧；动画按时间推进，帧率只影响流畅度
+// - 画面相关状态（摄像机、选中层、魔方状态、提示文字）与上一帧相同时跳过绘制，
+//   并阻塞等待输入事件，魔方静止时几乎不占 CPU
+class FrameScheduler {
+public:
+    // activeFps 为 0 时跟随显示器刷新率
+    explicit FrameScheduler(int activeFps = 0);
+
+    // 每帧在 controller.update 之前调用：根据当前状态设置帧率和事件等待方式
+    void beginFrame(const Controller &controller);
+    // 在 beginFrame 之后调用：距上一帧的秒数，用于推进动画；上一帧处于等待事件模式时返回 0（等待的时长不算动画时间）
+    // 跳过绘制的帧不经过 EndDrawing，GetFrameTime 不可靠，这里自己计时
+    float frameTime();
+    // 在 controller.update 之后调用：画面是否需要重绘
+    bool needsRedraw(const Cube &cube, const Controller &controller);
+    // 本帧不重绘时调用：处理输入事件（空闲时阻塞直到有事件）
+    void skipFrame();
+    // 强制下一帧重绘（例如窗口大小改变、叠加层切换）
+    void invalidate() { dirty = true; }
+
+private:
+    // 影响画面的全部状态
+    struct ViewState {
+        float yaw, pitch, distance;
+        Axis selectedAxis;
+        int selectedLayer;
+        bool highlight, scrambling, solving, rotating, profiler;
+        float angle;
+        CubieState cubies;
+
+        bool operator==(const ViewState &o) const;
+    };
+    static ViewState capture(const Cube &cube, const Controller &controller);
+
+    int activeFps;
+    int currentFps;
+    bool waiting;      // 是否处于“阻塞等待事件”模式
+    bool dirty;        // 强制重绘
+    bool changed;      // 上一帧画面有变化（按住按键时保持连续出帧）
+    bool hasLast;
+    bool blocked;      // 上一帧处于等待事件模式
+    ViewState last;
+    std::chrono::steady_clock::time_point lastTick;
+};
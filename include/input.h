@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+
+// 输入源：Controller 只通过它读取键盘状态，便于在没有窗口时用脚本驱动
+// 键值沿用 raylib 的 KEY_* 编号
+class InputSource {
+public:
+    virtual ~InputSource() = default;
+    // 每帧开始时调用一次（脚本输入在这里推进到下一帧）
+    virtual void beginFrame() {}
+    virtual bool isKeyDown(int key) const = 0;
+    virtual bool isKeyPressed(int key) const = 0;
+};
+
+// 实际键盘：转发给 raylib（需要已打开窗口）
+class RaylibInput : public InputSource {
+public:
+    bool isKeyDown(int key) const override;
+    bool isKeyPressed(int key) const override;
+};
+
+// 脚本输入：每个字符代表一帧里“按下”的一个键，用于无窗口运行和压力测试
+//   A-Z: 对应字母键   < > ^ v: 方向键   '.': 空一帧
+//   '_': 等到 Controller 空闲（没有动画、队列和后台求解）再继续
+// 按下的键同时视为 isKeyDown
+class ScriptedInput : public InputSource {
+public:
+    explicit ScriptedInput(const std::string &script, bool loop = false);
+
+    void beginFrame() override;
+    bool isKeyDown(int key) const override { return key == current; }
+    bool isKeyPressed(int key) const override { return key == current; }
+
+    // 当前是否停在 '_' 上等待空闲；调用方在 Controller 空闲时调用 resume()
+    bool waitingForIdle() const { return waiting; }
+    void resume() { waiting = false; }
+    bool finished() const { return !loop && pos >= script.size() && !waiting; }
+
+private:
+    std::string script;
+    bool loop;
+    size_t pos;
+    int current;
+    bool waiting;
+};
@@ -0,0 +1,112 @@
+#pragma once
+#include "cube.h"
+#include "moves.h"
+#include "command_ring.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// 转动日志：一个会话里实际作用到魔方上的每个转动（键盘、打乱、求解、回放），二进制紧凑格式
+//
+// 文件布局（小端）：
+//   文件头 16 字节：magic "RBKLOG01"，u32 版本，u32 检查点间隔
+//   之后是记录流，按首字节区分：
+//   - 转动（首字节最高位为 0）：低 5 位 MoveId，第 5-6 位来源（CommandSource），
+//     后跟与上一条记录的时间差（单位 10 ms，LEB128 变长，通常 1 字节）——每个转动约 2 字节
+//   - 检查点（首字节 0x80）：u32 已记录的转动数，u32 时间（10 ms），32 字节 CubieState，共 41 字节
+// 每 interval 个转动写一个检查点，打开文件时的初始状态也是一个检查点。
+// 记录只追加、按检查点刷新到磁盘，录制中的文件可以被同时读取；结尾不完整的记录会被忽略
+struct MoveLogEntry {
+    MoveId move;
+    CommandSource source;
+    uint32_t timeCs;  // 从开始录制算起的时间（10 ms）
+};
+
+class MoveLogWriter {
+public:
+    static constexpr uint32_t kDefaultInterval = 256;
+
+    MoveLogWriter() = default;
+    ~MoveLogWriter();
+
+    MoveLogWriter(const MoveLogWriter &) = delete;
+    MoveLogWriter &operator=(const MoveLogWriter &) = delete;
+
+    // 新建（覆盖）日志文件，initial 为录制开始时魔方的状态，失败返回 false
+    bool open(const std::string &path, const CubieState &initial, uint32_t interval = kDefaultInterval);
+    bool isOpen() const { return file != nullptr; }
+    // 记录一个已作用到魔方上的转动；after 为转动后的状态（到检查点时写入），seconds 为录制时钟
+    void append(MoveId move, CommandSource source, double seconds, const CubieState &after);
+    void flush();
+    void close();
+
+    size_t moveCount() const { return count; }
+
+private:
+    void writeCheckpoint(const CubieState &state);
+
+    FILE *file = nullptr;
+    uint32_t interval = kDefaultInterval;
+    size_t count = 0;
+    uint32_t lastCs = 0;
+};
+
+// 只读打开日志（mmap），打开时扫描一遍建立检查点索引；
+// 任意位置的状态从不超过一个检查点间隔的转动重放得到
+class MoveLogReader {
+public:
+    MoveLogReader() = default;
+    ~MoveLogReader();
+
+    MoveLogReader(const MoveLogReader &) = delete;
+    MoveLogReader &operator=(const MoveLogReader &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+
+    // 日志中完整记录的转动数
+    size_t size() const { return moveCount; }
+    uint32_t interval() const { return checkpointInterval; }
+    // 第 index 个转动之后（index = 0 为录制开始时）的魔方状态，index 超出时取最后的状态
+    CubieState stateAt(size_t index) const;
+    // 从第 first 个转动开始读取最多 n 条，返回读到的条数
+    size_t read(size_t first, size_t n, std::vector<MoveLogEntry> &out) const;
+
+private:
+    struct Checkpoint {
+        size_t index;    // 检查点之前已记录的转动数
+        size_t offset;   // 检查点之后第一条记录的文件偏移
+        uint32_t timeCs;
+        CubieState state;
+    };
+    // 从不晚于 index 的最后一个检查点开始，跳过 index - cp.index 个转动
+    const Checkpoint &checkpointFor(size_t index) const;
+
+    const uint8_t *data = nullptr;
+    size_t length = 0;
+    uint32_t checkpointInterval = 0;
+    size_t moveCount = 0;
+    std::vector<Checkpoint> checkpoints;
+};
+
+class Controller;
+
+// 回放：把日志中的转动逐个送入 Controller 的指令队列，走与打乱/求解相同的动画路径
+class MoveLogPlayer {
+public:
+    // 把魔方设为第 start 个转动之后的状态，从那里开始播放
+    MoveLogPlayer(const MoveLogReader &reader, Cube &cube, size_t start = 0);
+
+    // 每帧调用：Controller 没有待播放的指令时送入下一个转动
+    void feed(Controller &controller);
+    bool finished() const { return next >= reader.size(); }
+    size_t position() const { return next; }
+
+private:
+    const MoveLogReader &reader;
+    size_t next;
+    std::vector<MoveLogEntry> buffer;
+    size_t bufferFirst;
+};
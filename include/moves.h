@@ -0,0 +1,93 @@
+#pragma once
+#include "cube.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 魔方转动编号：6 个外层面 × {90°, 180°, -90°} 共 18 个，再加 M/E/S 三个中层
+// 编号 = 面 * 3 + 幂次（0: X, 1: X2, 2: X'），面顺序与 min2phase 一致：U R F D L B
+enum MoveId : uint8_t {
+    MoveU = 0, MoveU2, MoveUPrime,
+    MoveR, MoveR2, MoveRPrime,
+    MoveF, MoveF2, MoveFPrime,
+    MoveD, MoveD2, MoveDPrime,
+    MoveL, MoveL2, MoveLPrime,
+    MoveB, MoveB2, MoveBPrime,
+    MoveM, MoveM2, MoveMPrime,   // 中层（跟随 L）
+    MoveE, MoveE2, MoveEPrime,   // 中层（跟随 D）
+    MoveS, MoveS2, MoveSPrime,   // 中层（跟随 F）
+    MoveCount,
+    MoveFaceCount = MoveM        // 只含外层的 18 个转动
+};
+
+// 面（Face 枚举）在复原朝向下的 facelet 字母，例如 UP -> 'U'
+inline char faceLetter(int face)
+{
+    static const char kLetters[6] = {'L', 'R', 'D', 'U', 'B', 'F'};
+    return kLetters[face];
+}
+
+// 转动的名字，例如 "R2"、"U'"
+const char *moveName(MoveId move);
+// 解析单个转动名，成功返回 true
+bool parseMove(const char *text, MoveId &move);
+// 逆转动
+inline MoveId inverseMove(MoveId move)
+{
+    return static_cast<MoveId>(move - move % 3 + 2 - move % 3);
+}
+// 转动所在的面（0..8，对应 U R F D L B M E S）与幂次（0: 90°, 1: 180°, 2: -90°）
+inline int moveFace(MoveId move) { return move / 3; }
+inline int movePower(MoveId move) { return move % 3; }
+
+// 与 Cube::rotateLayer(axis, layer, clockwise) 的参数互相转换（只对应 90° 转动）
+MoveId moveFromLayer(Axis axis, int layer, bool clockwise);
+void layerFromMove(MoveId move, Axis &axis, int &layer, bool &clockwise);
+
+// 原地化简转动序列：抵消互逆转动、合并同一面的转动（R R -> R2），并让同轴的转动
+// （如 L、M、R 互相可交换）越过彼此以暴露更多抵消（L R L' -> R）；返回减少的转动个数
+size_t simplifyMoves(std::vector<MoveId> &moves);
+// 原地取逆：倒序并把每个转动换成逆转动
+void invertMoves(std::vector<MoveId> &moves);
+
+// 转动内核：对 32 字节小块状态或 64 字节贴纸数组做一次整体字节置换
+// 有 AVX2 / SSSE3 / NEON 时走向量化路径，否则按同一张表逐字节搬移
+void applyMove(CubieState &state, MoveId move);
+void applyMove(FaceletState &state, MoveId move);
+void applySequence(CubieState &state, const MoveId *moves, size_t count);
+
+// 位置 (x,y,z) 的槽位在 CubieState 中的字节下标（核心块为 -1）
+int slotByte(int x, int y, int z);
+// 由小块状态推导位置 (x,y,z) 的 face 面上贴纸原本所属的面，无贴纸返回 -1
+int stickerHome(const CubieState &state, int x, int y, int z, Face face);
+// 54 个 facelet（URFDLB 顺序）上贴纸原本所属的面
+void stickerHomes(const CubieState &state, uint8_t homes[54]);
+
+// 小块转动表的只读视图（批量内核用）：new.b[i] = old.b[perm[i]] + delta[i]，不小于 mod[i] 时减去 mod[i]
+// touched 列出该转动实际改动的字节，其置换只在这些字节之间进行
+struct CubieMoveView {
+    const uint8_t *perm;
+    const uint8_t *delta;
+    const uint8_t *mod;
+    const uint8_t *touched;
+    int touchedCount;
+};
+CubieMoveView cubieMoveView(MoveId move);
+
+// facelet 序号 -> 决定它的状态字节，以及“字节值 -> 贴纸原本所属的面”的 32 项查表
+struct FaceletSource {
+    uint8_t byte;
+    const uint8_t *home; // home[32]
+};
+FaceletSource faceletSource(int facelet);
+// 复原状态的小块状态
+CubieState solvedCubieState();
+
+// 24 种整体朝向，每种展开为若干个三层同向的 x / y 整体转动（中心块随之移动），第一个为恒等
+const std::vector<std::vector<MoveId>> &cubeRotations();
+// 使中心块回到原位的整体转动（state 再作用它之后中心归位）；中心排列不可能出现时返回 nullptr
+const std::vector<MoveId> *centerRotation(const CubieState &state);
+// 按整体转动共轭外层转动序列：每个 m 换成 rotation m rotation^-1（仍是一个外层转动）
+void conjugateMoves(std::vector<MoveId> &moves, const std::vector<MoveId> &rotation);
+// 逆状态：复原状态先做到达 state 的转动、再做到达 inverseState(state) 的转动，回到复原
+CubieState inverseState(const CubieState &state);
@@ -0,0 +1,39 @@
+#pragma once
+#include "cube.h"
+#include "moves.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 最优解（HTM）：Korf 的 IDA*，启发函数取三张模式数据库的最大值
+//   - 8 个角块的位置与朝向：8! * 3^7 = 88179840 项
+//   - 棱块 0..5、棱块 6..11 各自的位置与朝向：12!/6! * 2^6 = 42577920 项
+// 每项为该子状态到复原的最少步数，4 位一项，共约 87 MB。第一次使用时多线程逐层 BFS 生成并写入磁盘缓存，
+// 之后 mmap 只读加载（多个进程共享页缓存）。
+// 搜索把根展开 3 层得到几千棵子树，各线程从共享计数器领取，先做完的线程接着领剩下的子树
+struct OptimalResult {
+    bool solved;               // 在时间预算内找到了解，此时 moves 为最优解
+    std::vector<MoveId> moves; // 只含 18 个外层转动，作用在原状态上后魔方复原（整体朝向可能不同）
+    int depth;                 // 已穷尽的深度：solved 时即解长，否则最优解至少为 depth + 1 步
+    uint64_t nodes;
+    double seconds;
+};
+
+class OptimalSolver {
+public:
+    // 保证模式数据库已就绪（线程安全；没有缓存时要生成，单核约一分钟）
+    static void ensureReady();
+    static bool isReady();
+    // $RUBIK_PDB_CACHE，否则放在 TableCache::cacheDir() 下
+    static std::string cachePath();
+
+    // 求最优解；budgetSeconds <= 0 表示不限时，threads 为 0 时使用硬件线程数
+    // 中心块不在原位（中层转动或整体翻转过）时先整体转回，解再换算回当前朝向下的外层转动
+    // cancel 非空时，它变为 true 后搜索在几毫秒内停止，按超时处理（solved 为 false）
+    static OptimalResult solve(const CubieState &state, double budgetSeconds, size_t threads = 0,
+                               const std::atomic<bool> *cancel = nullptr);
+    // 启发函数：三张表的最大值（中心块须在原位），复原状态为 0
+    static int lowerBound(const CubieState &state);
+};
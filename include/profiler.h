@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 每帧计时的分区
+enum ProfileZone {
+    ZoneUpdate = 0,   // Controller::update
+    ZoneDraw3D,       // drawFrame 的魔方 3D 绘制
+    ZoneHighlight,    // drawFrame 的选中层高亮
+    ZoneUI,           // drawFrame 的文字界面
+    ZoneSolve,        // Solver::solve（可能在后台线程，计入其完成的那一帧）
+    ZoneRotateLayer,  // 完成动画后对 Cube 的 rotateLayer 调用
+    ZoneCount
+};
+
+// 一帧的计时（微秒）
+struct FrameSample {
+    uint64_t frame;
+    float intervalUs;  // 与上一帧开始之间的间隔（即帧时间，含等待）
+    float cpuUs;       // beginFrame 到 endFrame 的耗时
+    float zoneUs[ZoneCount];
+    bool drawn;        // 本帧是否绘制（调度器判定画面无变化时只处理输入，不绘制）
+};
+
+// 帧计时器：固定大小的环形缓冲区，主线程写入；各分区的耗时先原子累加，endFrame 时归入当前帧，
+// 因此后台线程（求解）也可以无锁地上报耗时
+class Profiler {
+public:
+    static constexpr size_t kCapacity = 4096;
+
+    // 每次主循环迭代各调用一次；跳过绘制的帧也要 endFrame(false)，否则其分区耗时会算到下一帧头上
+    static void beginFrame();
+    static void endFrame(bool drawn = true);
+    static void add(ProfileZone zone, std::chrono::steady_clock::duration elapsed);
+
+    // 最近写入的帧数（不超过 kCapacity）以及按时间顺序取第 i 帧（0 为最旧）
+    static size_t count();
+    static FrameSample sample(size_t i);
+    // 最近 n 帧中绘制过的帧的帧时间分位数（p 取 0..1），单位微秒
+    static float intervalPercentile(size_t n, float p);
+    // 把缓冲区内所有帧写成 CSV，成功返回 true
+    static bool dumpCsv(const std::string &path);
+
+    static const char *zoneName(ProfileZone zone);
+};
+
+// 作用域计时：构造时开始，析构时计入对应分区
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileZone zone) : zone(zone), start(std::chrono::steady_clock::now()) {}
+    ~ProfileScope() { Profiler::add(zone, std::chrono::steady_clock::now() - start); }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    ProfileZone zone;
+    std::chrono::steady_clock::time_point start;
+};
@@ -3,6 +3,7 @@
 #include "controller.h"
 #include "scrambler.h"
 #include <raylib.h>
+#include <vector>
 
 class Renderer {
 public:
@@ -10,10 +11,41 @@ public:
     ~Renderer();
     // 绘制一帧场景
     void drawFrame(const Cube &cube, const Controller &controller);
+    // 窗口是否被关闭
+    bool shouldClose() const { return WindowShouldClose(); }
 
 private:
+    static Mesh genStickerMesh();
+    void updateInstances(const Cube &cube, const Controller &controller);
+    void drawInstances();
+    void drawProfilerOverlay();
+
     Camera3D camera;  // Raylib 3D 摄像机
     int screenWidth;
     int screenHeight;
     Image background;
+
+    // 实例化绘制：6 种贴纸颜色（按 Face 枚举）+ 小块本体，各一组实例变换
+    static constexpr int kBodyGroup = 6;
+    static constexpr int kGroupCount = 7;
+    Mesh bodyMesh;
+    Mesh stickerMesh;
+    Material material;  // 实例化着色器，颜色按组设置
+    std::vector<Matrix> staticInstances[kGroupCount];  // 不在转动层的实例，状态不变时复用
+    std::vector<Matrix> movingInstances[kGroupCount];  // 正在转动的实例，每帧重建
+    bool cacheValid;
+    CubieState cachedState;
+    int cachedMovingKey;
+    int cachedViewKey;  // 外表面与切面相对摄像机的朝向（见 updateInstances）
+};
+
+// 无窗口模式的渲染器：不创建窗口和 GL 上下文，只统计帧数
+class NullRenderer {
+public:
+    void drawFrame(const Cube &, const Controller &) { ++frames; }
+    bool shouldClose() const { return false; }
+    long frameCount() const { return frames; }
+
+private:
+    long frames = 0;
 };
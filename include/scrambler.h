@@ -1,6 +1,9 @@
 #pragma once
 
 #include "cube.h"
+#include "moves.h"
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 struct RotationCommand
@@ -10,5 +13,42 @@ struct RotationCommand
     bool clockwise;
 };
 
-// 生成随机打乱序列（避免连续重复）
-std::vector<RotationCommand> generateScramble(int count = 20);
\ No newline at end of file
+// xoshiro256** 伪随机数：显式种子（经 splitmix64 展开为 256 位状态），同一种子在任何平台上序列相同
+class ScrambleRng {
+public:
+    explicit ScrambleRng(uint64_t seed);
+
+    uint64_t next()
+    {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+    // [0, n) 上均匀分布（Lemire 乘法取高位，拒绝采样消除偏差）
+    uint32_t below(uint32_t n);
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    uint64_t s[4];
+};
+
+// 在全部 43252003274489856000 个合法状态中均匀抽取一个（中心块在原位）
+CubieState randomCubieState(ScrambleRng &rng);
+
+// 随机状态打乱：求解 state 后取逆，得到从复原状态到达 state 的转动序列（需要 min2phase 的表）
+std::vector<MoveId> scrambleForState(const CubieState &state);
+// 转动序列 -> 打乱指令（180° 转动展开为两个 90° 指令）
+std::vector<RotationCommand> toScrambleCommands(const std::vector<MoveId> &moves);
+
+// 生成随机打乱序列（避免连续重复），结果已经过 simplifyScramble 化简
+std::vector<RotationCommand> generateScramble(int count = 20);
+// 随机状态打乱：min2phase 的表已就绪时使用，否则退回 generateScramble
+std::vector<RotationCommand> generateRandomStateScramble();
+// 化简打乱指令：抵消互逆转动、合并同一面的转动（见 simplifyMoves）
+std::vector<RotationCommand> simplifyScramble(const std::vector<RotationCommand> &sequence);
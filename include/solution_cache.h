@@ -0,0 +1,36 @@
+#pragma once
+#include "cube.h"
+#include "moves.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 解的来源：命中时只接受不低于请求引擎的记录（最优解能回答任何请求，min2phase 的解只回答 min2phase 请求）
+enum SolutionQuality : uint8_t {
+    QualityTwoPhase = 0,
+    QualityPortfolio,
+    QualityOptimal
+};
+
+// 求解结果缓存：以对称约化后的规范形（见 symmetry.h）为键，同一对称类的状态共用一条记录，
+// 命中时解经对称与整体转动换算回调用方的状态。两层：
+//   - 内存中的 LRU：最近用过的解（已解码），命中只需算一次规范形，约 1 微秒
+//   - 磁盘上只追加的记录文件，启动时 mmap 并扫描建立索引，跨进程、跨重启保留
+// 文件布局：16 字节文件头（magic "RBKSOL01"，u32 版本，u32 保留），之后每条记录为
+//   u8 步数 n，u8 来源（SolutionQuality），32 字节规范形状态，n 个 MoveId
+// 同一状态有多条记录时取来源更好、其次更短的；结尾不完整的记录被忽略。
+// 写入用 O_APPEND 加文件锁，多个进程可以共用同一个文件。所有函数线程安全
+class SolutionCache {
+public:
+    // 查找 state 的解；命中时 moves 为作用在 state 上的外层转动序列，quality 为记录的来源
+    static bool lookup(const CubieState &state, std::vector<MoveId> &moves, SolutionQuality *quality = nullptr);
+    // 记录 state 的解（须为把 state 复原的外层转动序列，否则忽略）；复原状态不记录
+    static void insert(const CubieState &state, const std::vector<MoveId> &moves, SolutionQuality quality);
+
+    // $RUBIK_SOLUTION_CACHE，否则放在 TableCache::cacheDir() 下
+    static std::string cachePath();
+    // 关闭后 lookup 总是未命中、insert 不做任何事（默认开启）
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+};
@@ -1,7 +1,32 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <functional>
 #include <vector>
 #include <string>
 #include "cube.h"
+#include "moves.h"
+
+// 求解引擎：min2phase 两阶段（毫秒级，接近最优）、IDA* 最优解（见 optimal_solver.h，可能很慢，受时间预算限制），
+// 或在线程池上同时求解多个等价变体的 min2phase 组合（见 PortfolioOptions）；
+// anytime 与组合求解相同，但每找到更短的解就发布一次（SolverWorker 流式送出，动画不等搜索结束）
+enum SolverEngine {
+    SolverTwoPhase = 0,
+    SolverOptimal,
+    SolverPortfolio,
+    SolverAnytime
+};
+
+// 组合求解：原状态、逆状态与整体转动后的状态是同一个问题的不同写法，min2phase 对它们给出的解长度不同。
+// 每个变体在线程池上反复以“当前最短解 - 1”为深度上限求解，解换算回原状态后取最短的
+struct PortfolioOptions {
+    size_t variants = 6;        // 1..48：朝向轮流让三个轴处在 UD 方向，每个朝向依次取原状态、逆状态；6 即三轴 × 正逆
+    double budgetSeconds = 0.5; // 墙钟预算：到时返回已有的最短解（还没有任何解时等到第一个）
+    int probeMax = 1000000;        // 每个变体第一次求解的 probe 上限
+    // 有了解之后以“当前最短 - 1”为深度上限的压缩求解用的 probe 上限（不超过 probeMax）：
+    // 找不到更短解的那次调用会把上限跑满，调低它才能让调用方返回后线程池里剩下的工作很快结束
+    int tightenProbeMax = 100000;
+};
 
 // 旋转指令结构（与控制器兼容）
 struct RotationCommandSolver {
@@ -14,7 +39,32 @@ class Solver {
 public:
     // 从当前魔方状态生成 Min2PhaseCXX 所需的 facelet 字符串
     static std::string encodeFacelets(const Cube& cube);
+    // 同上，写入调用方提供的数组，不分配内存；魔方开启了贴纸跟踪时只是一次拷贝
+    static void encodeFacelets(const Cube& cube, std::array<char, 54>& out);
+    // 反方向：facelet 字符串 -> 小块状态；贴纸组合对不上任何块、或有块重复时返回 false
+    static bool decodeFacelets(const std::string& facelets, CubieState& state);
+
+    // 求解：将当前魔方状态转为字符串并调用 Min2PhaseCXX，结果经 simplifyMoves 化简
+    // engine 为 SolverOptimal 时先做最优搜索，预算内没有结果就退回 min2phase；SolverPortfolio 见 solvePortfolio
+    // budgetSeconds <= 0 时使用引擎的默认预算（见 defaultBudget）
+    // 不合法的状态（见 validateState）直接返回空序列；先查 SolutionCache，来源不低于该引擎的记录直接返回；求得的解写回缓存
+    // cancel 非空且变为 true 时，组合求解与最优搜索尽快停止，返回空序列（不退回 min2phase，也不写缓存）
+    static std::vector<RotationCommandSolver> solve(const Cube& cube, SolverEngine engine = SolverTwoPhase,
+                                                    double budgetSeconds = 0, const std::atomic<bool>* cancel = nullptr);
+    // 各引擎的默认时间预算（秒）：最优 30，组合 0.5，anytime 3（动画已经开始，多搜一会儿不影响响应）
+    static double defaultBudget(SolverEngine engine);
+    // 组合求解，返回化简后的转动序列（复原状态返回空序列，所有变体都失败时也为空）
+    // onImprove 非空时，每当最短解变短就以新解调用一次（在线程池线程上、串行调用；本函数返回后不再调用）
+    // cancel 非空且变为 true 时在几毫秒内返回目前的最短解（可能为空），各变体跑完当前这次 min2phase 调用后退出
+    static std::vector<MoveId> solvePortfolio(const Cube& cube, const PortfolioOptions& options = PortfolioOptions(),
+                                              const std::function<void(const std::vector<MoveId>&)>& onImprove = nullptr,
+                                              const std::atomic<bool>* cancel = nullptr);
 
-    // 求解：将当前魔方状态转为字符串并调用 Min2PhaseCXX
-    static std::vector<RotationCommandSolver> solve(const Cube& cube);
-};
\ No newline at end of file
+    // 直接求解 facelet 字符串，返回 min2phase 的原始输出（不打印日志，可在多个线程中并发调用）
+    // 先经 validateFacelets 检查，不合法时直接返回 "Error N"（见 state_validator.h）
+    static std::string solveFacelets(const std::string& facelets, int maxDepth = 21, int probeMax = 1000000);
+    // 解析 min2phase 的输出为转动序列（遇到 "=>" 或长度标记即停止）
+    static std::vector<MoveId> parseSolution(const std::string& solution);
+    // 转动序列 -> 动画指令（180° 转动展开为两个 90° 指令）
+    static std::vector<RotationCommandSolver> toCommands(const std::vector<MoveId>& moves);
+};
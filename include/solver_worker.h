@@ -0,0 +1,64 @@
+#pragma once
+#include "cube.h"
+#include "scrambler.h"
+#include "solver.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 后台求解线程：主线程提交魔方快照后立即返回，每帧用 poll() 取结果，渲染循环不会被求解阻塞
+// 线程启动时顺带预热 min2phase 的表（TableCache），第一次按 U 也不用等建表
+// SolverAnytime 请求的结果是流式的：每有更短的解就可以用 pollStream 取到一次，直到 final
+// 随机状态打乱同样要跑一次 min2phase，也在这个线程上生成（submitScramble / pollScramble）
+class SolverWorker {
+public:
+    SolverWorker();
+    ~SolverWorker();  // 等待进行中的求解结束后退出
+
+    SolverWorker(const SolverWorker &) = delete;
+    SolverWorker &operator=(const SolverWorker &) = delete;
+
+    // 提交一次求解（覆盖尚未开始的旧请求），返回请求编号；engine / budgetSeconds 见 Solver::solve
+    uint64_t submit(const Cube &cube, SolverEngine engine = SolverTwoPhase, double budgetSeconds = 0);
+    // 提交一次随机状态打乱（见 generateRandomStateScramble，覆盖尚未开始的旧请求），返回请求编号
+    uint64_t submitScramble();
+    // 取消当前请求：正在进行的组合 / anytime / 最优搜索在几毫秒内停止，求解或打乱结果被丢弃
+    void cancel();
+    // 是否有已提交但还没取走结果的请求
+    bool busy() const;
+    // 若当前请求已完成，取出结果和求解时的快照并返回 true（非阻塞）
+    bool poll(std::vector<RotationCommandSolver> &solution, Cube &snapshot);
+    // anytime 请求：有新解（或搜索结束）时取出目前最短的完整解（从 snapshot 出发）并返回 true（非阻塞）；
+    // final 为 true 表示不会再有更新（此时 moves 可能与上次相同，搜索没有找到任何解时为空）
+    bool pollStream(std::vector<MoveId> &moves, Cube &snapshot, bool &final);
+    // 若打乱请求已完成，取出打乱指令并返回 true（非阻塞）
+    bool pollScramble(std::vector<RotationCommand> &scramble);
+
+private:
+    void run();
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::thread thread;
+    bool quit;
+    bool hasJob;          // 有等待开始的请求
+    bool jobScramble;     // 等待开始的请求是打乱而不是求解
+    bool hasResult;       // 有等待取走的结果
+    uint64_t generation;  // 最新请求的编号，取消或新提交都会使其增加
+    std::atomic<bool> stopJob;  // 取消或新提交时置位，让正在进行的搜索尽快返回；开始下一个请求时清除
+    Cube job;
+    SolverEngine jobEngine;
+    double jobBudget;
+    uint64_t jobGeneration;
+    Cube resultSnapshot;
+    uint64_t resultGeneration;
+    std::vector<RotationCommandSolver> result;
+    bool hasStream;       // 有未取走的流式更新
+    bool streamFinal;
+    std::vector<MoveId> streamMoves;
+    bool hasScramble;     // 有未取走的打乱
+    std::vector<RotationCommand> scrambleResult;
+};
@@ -0,0 +1,24 @@
+#pragma once
+#include "cube.h"
+#include <string>
+
+// 状态合法性检查：常数时间（查表解码 + 几十次比较，远小于 1 微秒），在交给求解器之前调用，
+// 不可能复原的状态立即报错，而不是让 min2phase / IDA* 把整个搜索预算耗完才失败。
+// 错误码与 min2phase 的 "Error N" 一致（按同样的顺序检查），7、8 留给搜索失败
+enum StateError {
+    StateOk = 0,
+    StateStickerCount = 1, // 不是 54 个字符、出现 URFDLB 以外的字母，或某种颜色不是 9 个
+    StateEdges = 2,        // 有棱块的颜色组合不存在，或同一棱块出现两次
+    StateFlip = 3,         // 棱块翻转之和为奇数（单独翻了一个棱块）
+    StateCorners = 4,      // 有角块的颜色组合不存在，或同一角块出现两次
+    StateTwist = 5,        // 角块扭转之和不是 3 的倍数（单独拧了一个角块）
+    StateParity = 6,       // 排列奇偶性不符（单独交换了两个块）
+    StateCenters = 9       // facelet 串的中心不在原位；小块状态的中心排列不是某个整体转动
+};
+
+// 检查 min2phase 格式的 facelet 串（URFDLB 顺序，中心须为 U R F D L B）
+StateError validateFacelets(const std::string &facelets);
+// 检查小块状态（中心块可以被中层转动移动过）
+StateError validateState(const CubieState &state);
+// 错误的简短英文说明
+const char *stateErrorMessage(StateError error);
@@ -0,0 +1,35 @@
+#pragma once
+#include "cube.h"
+#include "moves.h"
+#include <cstdint>
+#include <vector>
+
+// 状态哈希与对称约化
+//   - Zobrist 哈希：每个状态字节的每种取值对应一个固定的 64 位随机数，哈希为全部异或；
+//     一次转动只改动 CubieMoveView::touched 中的字节，增量更新只需重算这些字节
+//   - 48 种对称（24 种整体旋转 × 是否镜像）：对称 s 共轭状态 = 把魔方整体做几何变换 s，
+//     再按同一变换给贴纸重新涂色（颜色重映射），结果仍是合法状态，且 conj(A·B) = conj(A)·conj(B)
+// 共轭与转动的对应关系都在第一次使用时由几何推导成查表
+
+// 对称的个数；0 为恒等
+constexpr int kSymmetryCount = 48;
+
+// 全量计算哈希（随机数由固定种子生成，跨进程、跨平台稳定，可以写入磁盘）
+uint64_t zobristHash(const CubieState &state);
+// 转动并增量更新 hash（hash 须为 state 转动前的哈希）
+void applyMove(CubieState &state, MoveId move, uint64_t &hash);
+
+// 对称 s 共轭后的状态：若 moves 把 state 复原，则逐个 conjugateMove(m, s) 后把结果复原
+CubieState conjugateState(const CubieState &state, int symmetry);
+// 转动在对称 s 下的像（镜像对称会把顺时针变成逆时针）
+MoveId conjugateMove(MoveId move, int symmetry);
+void conjugateMoves(std::vector<MoveId> &moves, int symmetry);
+// 逆对称：conjugateState(conjugateState(x, s), inverseSymmetry(s)) == x
+int inverseSymmetry(int symmetry);
+// 是否含镜像
+bool isMirrorSymmetry(int symmetry);
+
+// 规范形：48 个共轭中字节序最小者，同一对称类的状态得到同一个规范形。
+// symmetry 返回所用的对称（canonical = conjugateState(state, *symmetry)），
+// 规范形的解经 conjugateMoves(moves, inverseSymmetry(*symmetry)) 换算回原状态的解
+CubieState canonicalState(const CubieState &state, int *symmetry = nullptr);
@@ -0,0 +1,17 @@
+#pragma once
+#include <string>
+
+// min2phase 转动表/剪枝表的磁盘缓存
+// 第一次运行时调用 min2phase::init() 生成表，写成带版本号与校验和的缓存文件；
+// 之后的运行先校验该文件再交给 min2phase 加载，不再重新生成。进程内只加载一次。
+class TableCache {
+public:
+    // 保证 min2phase 的表已就绪（线程安全，重复调用无开销）
+    static void ensureReady();
+    // 缓存文件路径：$RUBIK_TABLE_CACHE，否则 $XDG_CACHE_HOME/rubik3d 或 ~/.cache/rubik3d 下
+    static std::string cachePath();
+    // 缓存目录：$XDG_CACHE_HOME/rubik3d 或 ~/.cache/rubik3d（其它表文件也放在这里）
+    static std::string cacheDir();
+    // 表是否已在本进程内就绪
+    static bool isReady();
+};
@@ -0,0 +1,80 @@
+#include "command_ring.h"
+
+CommandRing::CommandRing(size_t capacity)
+    : tail(0), head(0)
+{
+    size_t n = 2;
+    while (n < capacity)
+        n <<= 1;
+    slots.reset(new Slot[n]);
+    mask = n - 1;
+    for (size_t i = 0; i < n; ++i)
+        slots[i].seq.store(i, std::memory_order_relaxed);
+    for (auto &c : pendingCount)
+        c.store(0, std::memory_order_relaxed);
+}
+
+bool CommandRing::push(const MoveCommand &cmd)
+{
+    return pushBatch(&cmd, 1);
+}
+
+bool CommandRing::pushBatch(const MoveCommand *cmds, size_t n)
+{
+    if (n == 0)
+        return true;
+    if (n > capacity())
+        return false;
+    size_t pos = tail.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        // 消费者按顺序释放槽位，所以最后一个槽空闲时前面的也都空闲
+        size_t seq = slots[(pos + n - 1) & mask].seq.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + n - 1);
+        if (diff == 0)
+        {
+            if (tail.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+            return false;  // 满
+        else
+            pos = tail.load(std::memory_order_relaxed);  // 被其它生产者抢先
+    }
+    // 已独占 [pos, pos + n)：先计数再发布，pending 不会小于消费者能看到的条数
+    for (size_t i = 0; i < n; ++i)
+        pendingCount[cmds[i].source].fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < n; ++i)
+    {
+        Slot &slot = slots[(pos + i) & mask];
+        slot.cmd = cmds[i];
+        slot.seq.store(pos + i + 1, std::memory_order_release);
+    }
+    return true;
+}
+
+bool CommandRing::pop(MoveCommand &cmd)
+{
+    size_t pos = head.load(std::memory_order_relaxed);
+    Slot &slot = slots[pos & mask];
+    if (slot.seq.load(std::memory_order_acquire) != pos + 1)
+        return false;
+    cmd = slot.cmd;
+    // 释放槽位给下一圈的生产者
+    slot.seq.store(pos + mask + 1, std::memory_order_release);
+    head.store(pos + 1, std::memory_order_relaxed);
+    pendingCount[cmd.source].fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+size_t CommandRing::size() const
+{
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t t = tail.load(std::memory_order_relaxed);
+    return t > h ? t - h : 0;
+}
+
+size_t CommandRing::pending(CommandSource source) const
+{
+    return pendingCount[source].load(std::memory_order_relaxed);
+}
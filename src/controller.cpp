@@ -1,10 +1,11 @@
 #include "controller.h"
+#include "move_log.h"
+#include "moves.h"
+#include "profiler.h"
+#include "table_cache.h"
 #include <raylib.h> // 键盘枚举KEY_* 定义
 #include <cmath>
-#include <queue>
 #include <iostream>
-std::queue<RotationCommand> scrambleQueue;
-std::queue<RotationCommandSolver> solverQueue;
 
 bool getVisualClockwise(Axis axis, float angle)
 {
@@ -31,129 +32,204 @@ Controller::Controller()
     selectedAxis = AxisX;
     selectedLayer = 0;
     rotating = false;
+    rotAxis = AxisX;
+    rotLayer = 0;
+    rotClockwise = true;
     currentAngle = 0.0f;
-    rotationSpeed = 6.0f; // 每帧旋转6度，90度约需15帧（~0.25秒）
+    rotProgress = 0.0f;
+    turnsPerSecond = 4.0f; // 每秒 4 个 90° 转动，一次约 0.25 秒
+    easing = true;
+    fastForwardSeconds = 0.0f;
+    solverEngine = SolverTwoPhase;
+    solverBudget = 0.0;
+    streamingSolve = false;
+    awaitingScramble = false;
     isHighlight = true;
     isSolving = false;
     isScrambling = false;
     isTurning = false;
+    showProfiler = false;
+    rotSource = SourceUser;
+    clockSeconds = 0.0;
+    moveLog = nullptr;
 }
 
-// 每帧调用：处理按键输入并更新状态
-void Controller::update(Cube &cube)
+// 把一条动画指令直接作用到魔方上（clockwise 为动画角度方向），开启了日志时同时记录
+void Controller::applyCommand(Cube &cube, Axis axis, int layer, bool clockwise, CommandSource source)
 {
+    ProfileScope scope(ZoneRotateLayer);
+    bool turn = getVisualClockwise(axis, clockwise ? 90.0f : -90.0f);
+    cube.rotateLayer(axis, layer, turn);
+    if (moveLog)
+        moveLog->append(moveFromLayer(axis, layer, turn), source, clockSeconds, cube.state());
+}
+
+void Controller::setTurnsPerSecond(float tps)
+{
+    turnsPerSecond = tps > 0.0f ? tps : 4.0f;
+}
+
+void Controller::setFastForward(float maxSeconds)
+{
+    fastForwardSeconds = maxSeconds > 0.0f ? maxSeconds : 0.0f;
+}
+
+void Controller::setSolverEngine(SolverEngine engine, double budgetSeconds)
+{
+    solverEngine = engine;
+    solverBudget = budgetSeconds;
+}
+
+size_t Controller::fastForwardCount(size_t queued) const
+{
+    if (fastForwardSeconds <= 0.0f)
+        return 0;
+    // 上限内能放完的条数，至少播放一条，否则队列会被一次清空、看不到任何动画
+    size_t keep = (size_t)(fastForwardSeconds * turnsPerSecond);
+    if (keep == 0)
+        keep = 1;
+    return queued > keep ? queued - keep : 0;
+}
+
+void Controller::startRotation(Axis axis, int layer, bool clockwise)
+{
+    rotating = true;
+    rotAxis = axis;
+    rotLayer = layer;
+    rotClockwise = clockwise;
+    rotProgress = 0.0f;
+    currentAngle = 0.0f;
+}
+
+// 按经过的时间推进动画：进度线性增长，角度按缓动曲线取值；到 90° 时更新魔方数据
+void Controller::advanceRotation(Cube &cube, float dt)
+{
+    // 整体翻转在画面上转 180°，用两倍的时间
+    float rate = isTurning ? turnsPerSecond * 0.5f : turnsPerSecond;
+    rotProgress += dt * rate;
+    if (rotProgress < 1.0f)
+    {
+        float t = easing ? rotProgress * rotProgress * (3.0f - 2.0f * rotProgress) : rotProgress;
+        currentAngle = (rotClockwise ? 90.0f : -90.0f) * t;
+        return;
+    }
+    // 强制将角度调整为 ±90 完成位置，调用 Cube 的 rotateLayer 更新魔方数据结构
+    currentAngle = rotClockwise ? 90.0f : -90.0f;
+    if (!isTurning)
+        applyCommand(cube, rotAxis, rotLayer, rotClockwise, rotSource);
+    else
+    {
+        // 整体翻转：绕 X 轴把每一层转两次；applyCommand 的 clockwise 是动画方向，X 轴上与 rotateLayer 相反
+        bool clockwise = !getVisualClockwise(rotAxis, currentAngle);
+        for (int i = 0; i <= 1; i++)
+            for (int j = 0; j < Cube::kLayerCount; j++)
+                applyCommand(cube, AxisX, j, clockwise, SourceUser);
+        isTurning = false;
+    }
+    // 重置动画状态
+    rotating = false;
+    rotProgress = 0.0f;
+    currentAngle = 0.0f;
+}
+
+// 每帧调用：处理按键输入并更新状态，dt 为距上一帧的秒数
+void Controller::update(Cube &cube, const InputSource &input, float dt)
+{
+    // 窗口拖动、阻塞等待事件之后的第一帧 dt 可能很大，限制单帧步长避免动画瞬间跳完
+    if (dt > 0.1f)
+        dt = 0.1f;
+    if (dt < 0.0f)
+        dt = 0.0f;
+    clockSeconds += dt;
+
     /***************/ /**SCRAMBLING**/ /***************/
-    // 若打乱队列非空，优先执行打乱
-    if (!scrambleQueue.empty())
+    // 后台生成的随机状态打乱到了：魔方没有在动才送入指令队列，否则丢弃
     {
-        if (!rotating)
+        std::vector<RotationCommand> scramble;
+        if (solver.pollScramble(scramble))
         {
-            RotationCommand cmd = scrambleQueue.front();
-            scrambleQueue.pop();
-            rotating = true;
-            rotAxis = cmd.axis;
-            rotLayer = cmd.layer;
-            rotClockwise = cmd.clockwise;
-            currentAngle = 0.0f;
+            awaitingScramble = false;
+            isScrambling = !rotating && commands.empty() && pushScramble(scramble);
         }
-        else
-        {
-            if (rotClockwise)
-                currentAngle += rotationSpeed;
-            else
-                currentAngle -= rotationSpeed;
-            // 完成旋转时（绝对角度达到或超过90度）
-            if ((rotClockwise && currentAngle >= 90.0f) || (!rotClockwise && currentAngle <= -90.0f))
-            {
-                // 强制将角度调整为 ±90 完成位置
-                currentAngle = rotClockwise ? 90.0f : -90.0f;
-                // 调用 Cube 的 rotateLayer 更新魔方数据结构
-                cube.rotateLayer(rotAxis, rotLayer, getVisualClockwise(rotAxis, currentAngle));
-                // 重置动画状态
-                rotating = false;
-                currentAngle = 0.0f;
-            }
-        }
-        // return;
     }
-    else if (isScrambling)
+    if (isScrambling && !awaitingScramble && commands.pending(SourceScramble) == 0)
         isScrambling = false;           // 打乱完成
     /***************/ /***************/ /***************/
 
     /***************/ /****SOLVING****/ /***************/
-    if (!solverQueue.empty())
+    if (isSolving && commands.pending(SourceSolver) == 0 && solveTail.empty() && !solver.busy())
+        isSolving = false;
+    // 后台求解完成：魔方仍是提交时的状态才采用结果，否则丢弃
     {
-        if (!rotating)
+        std::vector<RotationCommandSolver> solution;
+        Cube snapshot;
+        if (solver.poll(solution, snapshot))
         {
-            RotationCommandSolver cmd = solverQueue.front();
-            solverQueue.pop();
-            rotating = true;
-            rotAxis = cmd.axis;
-            rotLayer = cmd.layerIndex;
-            rotClockwise = cmd.clockwise;
-            currentAngle = 0.0f;
+            std::cout << "Solver returned " << solution.size() << " steps" << std::endl;
+            if (!(snapshot == cube && !rotating && pushSolution(solution)))
+                isSolving = false;
         }
-        else
+    }
+    // anytime 求解：第一个解一到就开始播放，之后的更短解替换尚未播放的部分
+    {
+        std::vector<MoveId> moves;
+        Cube snapshot;
+        bool final = false;
+        if (solver.pollStream(moves, snapshot, final))
         {
-            if (rotClockwise)
-                currentAngle += rotationSpeed;
-            else
-                currentAngle -= rotationSpeed;
-            // 完成旋转时（绝对角度达到或超过90度）
-            if ((rotClockwise && currentAngle >= 90.0f) || (!rotClockwise && currentAngle <= -90.0f))
-            {
-                // 强制将角度调整为 ±90 完成位置
-                currentAngle = rotClockwise ? 90.0f : -90.0f;
-                // 调用 Cube 的 rotateLayer 更新魔方数据结构
-                cube.rotateLayer(rotAxis, rotLayer, getVisualClockwise(rotAxis, currentAngle));
-                // 重置动画状态
-                rotating = false;
-                currentAngle = 0.0f;
-            }
+            acceptSolveUpdate(cube, moves, snapshot);
+            if (final && !streamingSolve)
+                isSolving = false;
+        }
+        feedSolve();
+        if (streamingSolve && solveTail.empty() && !solver.busy())
+        {
+            streamingSolve = false;
+            solvePlayed.clear();
         }
-        // return;
     }
-    else if (isSolving)
-        isSolving = false;
     /***************/ /***************/ /***************/
 
     // 摄像机控制 - WASD 控制视角环绕
-    float angleStep = 3.0f; // 每帧调整角度步长
-    if (IsKeyDown(KEY_A))
+    float angleStep = 180.0f * dt; // 每秒 180 度
+    float zoomStep = 6.0f * dt;     // 每秒 6 个单位
+    if (input.isKeyDown(KEY_A))
     { // 左旋转视角（绕Y轴增加偏航角）
         cameraYaw -= angleStep;
     }
-    if (IsKeyDown(KEY_D))
+    if (input.isKeyDown(KEY_D))
     { // 右旋转视角
         cameraYaw += angleStep;
     }
-    if (IsKeyDown(KEY_W))
+    if (input.isKeyDown(KEY_W))
     { // 上视角（增加俯仰角，但有限制）
         cameraPitch += angleStep;
         if (cameraPitch > 85.0f)
             cameraPitch = 85.0f; // 防止过顶
     }
-    if (IsKeyDown(KEY_S))
+    if (input.isKeyDown(KEY_S))
     { // 下视角
         cameraPitch -= angleStep;
         if (cameraPitch < -85.0f)
             cameraPitch = -85.0f; // 防止过底
     }
-    if (IsKeyDown(KEY_Q))
+    if (input.isKeyDown(KEY_Q))
     { // 拉近摄像机
-        cameraDistance -= 0.1f;
+        cameraDistance -= zoomStep;
         if (cameraDistance < 6.0f)
             cameraDistance = 6.0f; // 最小距离限制
     }
-    if (IsKeyDown(KEY_E))
+    if (input.isKeyDown(KEY_E))
     { // 拉远摄像机
-        cameraDistance += 0.1f;
+        cameraDistance += zoomStep;
         if (cameraDistance > 12.0f)
             cameraDistance = 12.0f; // 最大距离限制
     }
-    if (IsKeyPressed(KEY_T)){
+    // 环形队列里还有排队的指令时不响应：插进来的这一步会打乱它们的顺序
+    if (input.isKeyPressed(KEY_T) && !rotating && commands.empty()){
+        cancelSolve();
+        startRotation(rotAxis, rotLayer, rotClockwise);
         isTurning = true;
-        rotating = true;
     }
     // 限制 yaw 在 0-360 (可选)
     if (cameraYaw < 0)
@@ -161,125 +237,196 @@ void Controller::update(Cube &cube)
     if (cameraYaw >= 360.0f)
         cameraYaw -= 360.0f;
 
-    // 如果当前没有旋转动画进行，处理层选择和旋转输入
-    if (!rotating)
+    // 如果当前没有旋转动画、也没有排队的指令，处理层选择和旋转输入
+    if (!rotating && commands.empty())
     {
-        if (IsKeyPressed(KEY_R) && scrambleQueue.empty())
+        if (input.isKeyPressed(KEY_R) && !awaitingScramble)
         {
-            auto scramble = generateScramble(20);
-            for (auto &cmd : scramble)
-                scrambleQueue.push(cmd);
-            isScrambling = true;
+            cancelSolve();
+            // 随机状态打乱要跑一次 min2phase，交给后台线程，结果在之后的某一帧送入队列；
+            // 表还没就绪时退回随机转动，当场生成
+            if (TableCache::isReady())
+            {
+                solver.submitScramble();
+                awaitingScramble = true;
+                isScrambling = true;
+            }
+            else
+                isScrambling = pushScramble(generateScramble(20));
         }
-        if (IsKeyPressed(KEY_U) && solverQueue.empty()) {
+        if (input.isKeyPressed(KEY_U) && !solver.busy()) {
             std::cout << "U pressed! Calling Solver..." << std::endl;
-            std::vector<RotationCommandSolver> solution = Solver::solve(cube);
-            std::cout << "Solver returned " << solution.size() << " steps" << std::endl;
-            for (const auto& cmd : solution) 
-                solverQueue.push(cmd);
+            solver.submit(cube, solverEngine, solverBudget);
             isSolving = true;
         }
-        // 方向键选择轴和层：←→ 切换轴，↑↓ 切换层编号
-        if (IsKeyPressed(KEY_Z))
-        {
-            // 切换到X轴
-            if(selectedAxis == AxisX){
-                if (selectedLayer == 2) selectedLayer = 0;
-                else selectedLayer = 2;
-            }
-            else{
-                selectedLayer = 0;
-                selectedAxis = AxisX;
-            }
-        }
-        if (IsKeyPressed(KEY_X))
-        {
-            // 切换到Z轴
-            if(selectedAxis == AxisZ){
-                if (selectedLayer == 2) selectedLayer = 0;
-                else selectedLayer = 2;
-            }
-            else{
-                selectedLayer = 0;
-                selectedAxis = AxisZ;
-            }
-        }
-        if (IsKeyPressed(KEY_C))
-        {
-            // 切换到Y轴
-            if(selectedAxis == AxisY){
-                if (selectedLayer == 2) selectedLayer = 0;
-                else selectedLayer = 2;
-            }
-            else{
-                selectedLayer = 0;
-                selectedAxis = AxisY;
-            }
-        }
-        if (IsKeyPressed(KEY_LEFT))
+        // 方向键选择轴和层：←→ 切换轴，↑↓ 逐层切换层编号；Z/X/C 选轴，已在该轴时在两个外层之间切换
+        if (input.isKeyPressed(KEY_Z))
+            selectAxis(AxisX);
+        if (input.isKeyPressed(KEY_X))
+            selectAxis(AxisZ);
+        if (input.isKeyPressed(KEY_C))
+            selectAxis(AxisY);
+        if (input.isKeyPressed(KEY_LEFT))
         {
             // 切换到前一个轴 (X->Z->Y->X)
             selectedAxis = static_cast<Axis>((static_cast<int>(selectedAxis) + 2) % 3);
         }
-        if (IsKeyPressed(KEY_RIGHT))
+        if (input.isKeyPressed(KEY_RIGHT))
         {
             // 切换到下一个轴
             selectedAxis = static_cast<Axis>((static_cast<int>(selectedAxis) + 1) % 3);
         }
-        if (IsKeyPressed(KEY_UP))
+        if (input.isKeyPressed(KEY_UP))
         {
-            // 层索引 0-2 循环增加
-            if (selectedLayer == 2) selectedLayer = 0;
-            else selectedLayer = 2;
+            // 层索引 0..N-1 循环增加
+            selectedLayer = (selectedLayer + 1) % Cube::kLayerCount;
         }
-        if (IsKeyPressed(KEY_DOWN))
+        if (input.isKeyPressed(KEY_DOWN))
         {
             // 层索引 循环减少
-            if (selectedLayer == 2) selectedLayer = 0;
-            else selectedLayer = 2;
+            selectedLayer = (selectedLayer + Cube::kLayerCount - 1) % Cube::kLayerCount;
         }
         // 当按下 J 或 K 键时，启动旋转动画
-        if (IsKeyPressed(KEY_J) || IsKeyPressed(KEY_K))
+        if (input.isKeyPressed(KEY_J) || input.isKeyPressed(KEY_K))
         {
-            rotating = true;
-            rotAxis = selectedAxis;
-            rotLayer = selectedLayer;
+            cancelSolve();
             // J 设为顺时针，K 逆时针
-            rotClockwise = IsKeyPressed(KEY_J);
-            currentAngle = 0.0f;
+            commands.push({selectedAxis, (int8_t)selectedLayer, input.isKeyPressed(KEY_J), SourceUser});
         }
-        if (IsKeyPressed(KEY_P))
+        if (input.isKeyPressed(KEY_P))
         {
             isHighlight = !isHighlight;
             // 是否显示选中层高亮
         }
+        if (input.isKeyPressed(KEY_F1))
+        {
+            showProfiler = !showProfiler;
+            // 是否显示帧耗时叠加层
+        }
     }
+
+    // 所有来源的指令走同一条路径：没有动画时取下一条开始播放，然后按时间推进
+    if (!rotating)
+        startNextCommand(cube);
+    if (rotating)
+        advanceRotation(cube, dt);
+}
+
+// 取出下一条指令开始动画；积压的转动超过快进上限时，先把多余的直接应用（先取指令队列，
+// 再取 anytime 求解还没送出的尾巴），只播放最后能在上限内放完的部分
+void Controller::startNextCommand(Cube &cube)
+{
+    MoveCommand cmd;
+    size_t n = fastForwardCount(commands.size() + solveTail.size());
+    for (; n > 0 && commands.pop(cmd); --n)
+        applyCommand(cube, cmd.axis, cmd.layer, cmd.clockwise, cmd.source);
+    for (; n > 0 && !solveTail.empty(); --n)
+    {
+        MoveId move = solveTail.front();
+        solveTail.erase(solveTail.begin());
+        solvePlayed.push_back(move);
+        for (const RotationCommandSolver &c : Solver::toCommands({move}))
+            applyCommand(cube, c.axis, c.layerIndex, c.clockwise, SourceSolver);
+    }
+    feedSolve();
+    if (commands.pop(cmd))
+    {
+        startRotation(cmd.axis, cmd.layer, cmd.clockwise);
+        rotSource = cmd.source;
+    }
+}
+
+bool Controller::pushScramble(const std::vector<RotationCommand> &scramble)
+{
+    std::vector<MoveCommand> cmds;
+    cmds.reserve(scramble.size());
+    for (const auto &c : scramble)
+        cmds.push_back({c.axis, (int8_t)c.layer, c.clockwise, SourceScramble});
+    if (commands.pushBatch(cmds.data(), cmds.size()))
+        return !cmds.empty();
+    std::cout << "Command ring full, scramble dropped" << std::endl;
+    return false;
+}
+
+bool Controller::pushSolution(const std::vector<RotationCommandSolver> &solution)
+{
+    std::vector<MoveCommand> cmds;
+    cmds.reserve(solution.size());
+    for (const auto &c : solution)
+        cmds.push_back({c.axis, (int8_t)c.layerIndex, c.clockwise, SourceSolver});
+    if (commands.pushBatch(cmds.data(), cmds.size()))
+        return true;
+    std::cout << "Command ring full, solution dropped" << std::endl;
+    return false;
+}
+
+void Controller::acceptSolveUpdate(const Cube &cube, const std::vector<MoveId> &moves, const Cube &snapshot)
+{
+    if (!streamingSolve)
+    {
+        // 第一个解：魔方仍是提交时的状态才开始播放
+        if (moves.empty() || !(snapshot == cube && !rotating && commands.empty()))
+            return;
+        streamingSolve = true;
+        solvePlayed.clear();
+        solveTail = moves;
+        std::cout << "[Anytime] first solution " << moves.size() << " moves" << std::endl;
+        return;
+    }
+    // 已播放的前缀不能撤回：从当前进度出发的新尾巴 = 前缀的逆 + 新解，化简时两者的公共开头会抵消
+    std::vector<MoveId> tail = solvePlayed;
+    invertMoves(tail);
+    tail.insert(tail.end(), moves.begin(), moves.end());
+    simplifyMoves(tail);
+    if (tail.size() >= solveTail.size())
+        return;
+    std::cout << "[Anytime] remaining " << solveTail.size() << " -> " << tail.size() << " moves" << std::endl;
+    solveTail.swap(tail);
+}
+
+// 解一次只送一步进指令队列，后台找到更短的解时，还没送出的部分都可以换掉
+void Controller::feedSolve()
+{
+    if (!streamingSolve || solveTail.empty() || rotating || commands.pending(SourceSolver) != 0)
+        return;
+    MoveId move = solveTail.front();
+    solveTail.erase(solveTail.begin());
+    solvePlayed.push_back(move);
+    pushSolution(Solver::toCommands({move}));
+}
+
+// 选中某个轴；已经选中该轴时在两个外层（0 与 N-1）之间切换
+void Controller::selectAxis(Axis axis)
+{
+    if (selectedAxis == axis)
+        selectedLayer = selectedLayer == Cube::kLayerCount - 1 ? 0 : Cube::kLayerCount - 1;
     else
     {
-        // 正在旋转动画中：更新角度
-        if (rotClockwise)
-        {
-            currentAngle += rotationSpeed;
-        }
-        else
-        {
-            currentAngle -= rotationSpeed;
-        }
-        // 完成旋转时（绝对角度达到或超过90度）
-        if ((rotClockwise && currentAngle >= 90.0f) || (!rotClockwise && currentAngle <= -90.0f))
-        {
-            // 强制将角度调整为 ±90 完成位置
-            currentAngle = rotClockwise ? 90.0f : -90.0f;
-            // 调用 Cube 的 rotateLayer 更新魔方数据结构
-            if(!isTurning) cube.rotateLayer(rotAxis, rotLayer, getVisualClockwise(rotAxis, currentAngle));
-            else {
-                for(int i = 0; i <= 1; i++) for(int j=0;j<=2;j++) cube.rotateLayer(AxisX, j, getVisualClockwise(rotAxis, currentAngle));
-                SetTargetFPS(80);
-                isTurning = false;
-            }
-            // 重置动画状态
-            rotating = false;
-            currentAngle = 0.0f;
-        }
+        selectedLayer = 0;
+        selectedAxis = axis;
     }
 }
+
+// 用户动了魔方：后台求解的快照已过期，取消它
+void Controller::cancelSolve()
+{
+    bool active = streamingSolve || solver.busy();
+    streamingSolve = false;
+    solvePlayed.clear();
+    solveTail.clear();
+    if (!active)
+        return;
+    solver.cancel();
+    isSolving = false;
+    // 还没到的打乱也一并作废
+    if (awaitingScramble)
+    {
+        awaitingScramble = false;
+        isScrambling = false;
+    }
+}
+
+bool Controller::isIdle() const
+{
+    return !rotating && commands.empty() && !solver.busy() && !streamingSolve;
+}
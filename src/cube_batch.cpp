@@ -0,0 +1,274 @@
+#include "cube_batch.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const char kFaceletLetters[] = "URFDLB";
+
+size_t roundUp(size_t n)
+{
+    return (n + CubeBatch::kLaneBlock - 1) / CubeBatch::kLaneBlock * CubeBatch::kLaneBlock;
+}
+
+// 单个魔方按中心块重新映射：home 面 -> 当前中心在该面的 facelet 字母
+void encodeLane(const CubieState &s, char *out)
+{
+    uint8_t homes[54];
+    stickerHomes(s, homes);
+    char letter[6];
+    for (int k = 0; k < 6; ++k)
+        letter[homes[k * 9 + 4]] = kFaceletLetters[k];
+    for (int i = 0; i < 54; ++i)
+        out[i] = letter[homes[i]];
+}
+
+#if defined(__AVX2__)
+// 32 项字节查表：v 取值 0..31，低 16 项与高 16 项各做一次 pshufb 后按第 4 位选择
+inline __m256i lookup32(const uint8_t *lut, __m256i v)
+{
+    __m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lut)));
+    __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lut + 16)));
+    __m256i idx = _mm256_and_si256(v, _mm256_set1_epi8(15));
+    __m256i useHi = _mm256_cmpeq_epi8(_mm256_and_si256(v, _mm256_set1_epi8(16)), _mm256_set1_epi8(16));
+    return _mm256_blendv_epi8(_mm256_shuffle_epi8(lo, idx), _mm256_shuffle_epi8(hi, idx), useHi);
+}
+#endif
+
+} // namespace
+
+void CubeBatch::AlignedFree::operator()(uint8_t *p) const
+{
+    std::free(p);
+}
+
+CubeBatch::CubeBatch(size_t count)
+    : count(0), stride(0)
+{
+    resize(count);
+}
+
+void CubeBatch::resize(size_t n)
+{
+    size_t newStride = roundUp(n);
+    std::unique_ptr<uint8_t[], AlignedFree> buf;
+    if (newStride > 0)
+    {
+        buf.reset(static_cast<uint8_t *>(std::aligned_alloc(kLaneBlock, newStride * 32)));
+        if (!buf)
+            throw std::bad_alloc();
+    }
+    // 先全部填成复原状态，再拷回原有的魔方
+    CubieState solved = solvedCubieState();
+    for (int i = 0; i < 32 && newStride > 0; ++i)
+        memset(buf.get() + (size_t)i * newStride, solved.b[i], newStride);
+    size_t keep = n < count ? n : count;
+    for (int i = 0; i < 32 && keep > 0; ++i)
+        memcpy(buf.get() + (size_t)i * newStride, plane(i), keep);
+    data = std::move(buf);
+    stride = newStride;
+    count = n;
+}
+
+void CubeBatch::reset()
+{
+    CubieState solved = solvedCubieState();
+    for (int i = 0; i < 32; ++i)
+        memset(plane(i), solved.b[i], stride);
+}
+
+CubieState CubeBatch::get(size_t lane) const
+{
+    CubieState s;
+    for (int i = 0; i < 32; ++i)
+        s.b[i] = plane(i)[lane];
+    return s;
+}
+
+void CubeBatch::set(size_t lane, const CubieState &state)
+{
+    for (int i = 0; i < 32; ++i)
+        plane(i)[lane] = state.b[i];
+}
+
+Cube CubeBatch::cube(size_t lane) const
+{
+    Cube c;
+    c.setState(get(lane));
+    return c;
+}
+
+void CubeBatch::applyMove(MoveId move)
+{
+    // 只处理被转动的平面；置换只发生在这些平面之间，所以每块先全部算完再写回
+    CubieMoveView v = cubieMoveView(move);
+    int n = v.touchedCount;
+    uint8_t *src[12];
+    uint8_t *dst[12];
+    for (int k = 0; k < n; ++k)
+    {
+        dst[k] = plane(v.touched[k]);
+        src[k] = plane(v.perm[v.touched[k]]);
+    }
+#if defined(__AVX2__)
+    __m256i d[12], m[12];
+    for (int k = 0; k < n; ++k)
+    {
+        d[k] = _mm256_set1_epi8((char)v.delta[v.touched[k]]);
+        m[k] = _mm256_set1_epi8((char)v.mod[v.touched[k]]);
+    }
+    for (size_t off = 0; off < stride; off += kLaneBlock)
+    {
+        __m256i out[12];
+        for (int k = 0; k < n; ++k)
+        {
+            __m256i s = _mm256_add_epi8(_mm256_load_si256(reinterpret_cast<const __m256i *>(src[k] + off)), d[k]);
+            out[k] = _mm256_min_epu8(s, _mm256_sub_epi8(s, m[k]));
+        }
+        for (int k = 0; k < n; ++k)
+            _mm256_store_si256(reinterpret_cast<__m256i *>(dst[k] + off), out[k]);
+    }
+#else
+    uint8_t d[12], m[12];
+    for (int k = 0; k < n; ++k)
+    {
+        d[k] = v.delta[v.touched[k]];
+        m[k] = v.mod[v.touched[k]];
+    }
+    for (size_t off = 0; off < stride; off += kLaneBlock)
+    {
+        uint8_t out[12][kLaneBlock];
+        for (int k = 0; k < n; ++k)
+            for (size_t l = 0; l < kLaneBlock; ++l)
+            {
+                uint8_t s = (uint8_t)(src[k][off + l] + d[k]);
+                out[k][l] = s >= m[k] ? (uint8_t)(s - m[k]) : s;
+            }
+        for (int k = 0; k < n; ++k)
+            memcpy(dst[k] + off, out[k], kLaneBlock);
+    }
+#endif
+}
+
+void CubeBatch::applySequence(const MoveId *moves, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        applyMove(moves[i]);
+}
+
+void CubeBatch::applyMoves(const MoveId *moves)
+{
+    // 每个魔方转动不同：逐个取出为 32 字节状态，走单魔方的向量内核后写回
+    for (size_t lane = 0; lane < count; ++lane)
+    {
+        CubieState s = get(lane);
+        ::applyMove(s, moves[lane]);
+        set(lane, s);
+    }
+}
+
+void CubeBatch::encodeFacelets(char *out) const
+{
+    CubieState solved = solvedCubieState();
+    FaceletSource src[54];
+    for (int i = 0; i < 54; ++i)
+        src[i] = faceletSource(i);
+    // 中心块都在原位时 home 面直接对应字母，把两张表合成一张“字节值 -> 字母”的查表
+    alignas(16) uint8_t letterLut[54][32];
+    for (int i = 0; i < 54; ++i)
+        for (int v = 0; v < 32; ++v)
+            letterLut[i][v] = (uint8_t)faceLetter(src[i].home[v]);
+
+    for (size_t off = 0; off < count; off += kLaneBlock)
+    {
+        size_t lanes = count - off < kLaneBlock ? count - off : kLaneBlock;
+        bool centersHome = true;
+        for (int c = CubieState::kCenterOffset; c < CubieState::kCenterOffset + 6 && centersHome; ++c)
+            for (size_t l = 0; l < lanes; ++l)
+                centersHome &= plane(c)[off + l] == solved.b[c];
+        if (!centersHome)
+        {
+            for (size_t l = 0; l < lanes; ++l)
+                encodeLane(get(off + l), out + (off + l) * 54);
+            continue;
+        }
+        // 先按 facelet 主序算出 54 x 32 的字母块，再转置写到按魔方主序的输出
+        alignas(32) uint8_t block[54][kLaneBlock];
+        for (int i = 0; i < 54; ++i)
+        {
+            const uint8_t *p = plane(src[i].byte) + off;
+#if defined(__AVX2__)
+            __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i *>(p));
+            _mm256_store_si256(reinterpret_cast<__m256i *>(block[i]), lookup32(letterLut[i], v));
+#else
+            for (size_t l = 0; l < kLaneBlock; ++l)
+                block[i][l] = letterLut[i][p[l] & 31];
+#endif
+        }
+        for (size_t l = 0; l < lanes; ++l)
+        {
+            char *o = out + (off + l) * 54;
+            for (int i = 0; i < 54; ++i)
+                o[i] = (char)block[i][l];
+        }
+    }
+}
+
+size_t CubeBatch::solvedMask(uint8_t *solved) const
+{
+    FaceletSource src[54];
+    for (int i = 0; i < 54; ++i)
+        src[i] = faceletSource(i);
+
+    size_t total = 0;
+    for (size_t off = 0; off < count; off += kLaneBlock)
+    {
+        size_t lanes = count - off < kLaneBlock ? count - off : kLaneBlock;
+        alignas(32) uint8_t ok[kLaneBlock];
+#if defined(__AVX2__)
+        // 每个面：8 个非中心贴纸的 home 面都等于中心贴纸的 home 面
+        __m256i all = _mm256_set1_epi8(-1);
+        for (int f = 0; f < 6; ++f)
+        {
+            const FaceletSource &cs = src[f * 9 + 4];
+            __m256i center = lookup32(cs.home, _mm256_load_si256(reinterpret_cast<const __m256i *>(plane(cs.byte) + off)));
+            for (int k = 0; k < 9; ++k)
+            {
+                if (k == 4)
+                    continue;
+                const FaceletSource &s = src[f * 9 + k];
+                __m256i h = lookup32(s.home, _mm256_load_si256(reinterpret_cast<const __m256i *>(plane(s.byte) + off)));
+                all = _mm256_and_si256(all, _mm256_cmpeq_epi8(h, center));
+            }
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i *>(ok), _mm256_and_si256(all, _mm256_set1_epi8(1)));
+#else
+        memset(ok, 1, sizeof(ok));
+        for (int f = 0; f < 6; ++f)
+        {
+            const FaceletSource &cs = src[f * 9 + 4];
+            const uint8_t *cp = plane(cs.byte) + off;
+            for (int k = 0; k < 9; ++k)
+            {
+                if (k == 4)
+                    continue;
+                const FaceletSource &s = src[f * 9 + k];
+                const uint8_t *p = plane(s.byte) + off;
+                for (size_t l = 0; l < kLaneBlock; ++l)
+                    ok[l] &= s.home[p[l] & 31] == cs.home[cp[l] & 31];
+            }
+        }
+#endif
+        for (size_t l = 0; l < lanes; ++l)
+        {
+            solved[off + l] = ok[l];
+            total += ok[l];
+        }
+    }
+    return total;
+}
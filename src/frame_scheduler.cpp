@@ -0,0 +1,89 @@
+#include "frame_scheduler.h"
+#include <raylib.h>
+
+bool FrameScheduler::ViewState::operator==(const ViewState &o) const
+{
+    return yaw == o.yaw && pitch == o.pitch && distance == o.distance && selectedAxis == o.selectedAxis &&
+           selectedLayer == o.selectedLayer && highlight == o.highlight && scrambling == o.scrambling &&
+           solving == o.solving && rotating == o.rotating && profiler == o.profiler && angle == o.angle && cubies == o.cubies;
+}
+
+FrameScheduler::FrameScheduler(int activeFps)
+    : activeFps(activeFps), currentFps(0), waiting(false), dirty(true), changed(true),
+      hasLast(false), blocked(true), lastTick(std::chrono::steady_clock::now())
+{
+}
+
+FrameScheduler::ViewState FrameScheduler::capture(const Cube &cube, const Controller &controller)
+{
+    ViewState v;
+    v.yaw = controller.getCameraYaw();
+    v.pitch = controller.getCameraPitch();
+    v.distance = controller.getCameraDistance();
+    v.selectedAxis = controller.getSelectedAxis();
+    v.selectedLayer = controller.getSelectedLayer();
+    v.highlight = controller.getIsHighlight();
+    v.scrambling = controller.getIsScrambling();
+    v.solving = controller.getIsSolving();
+    v.rotating = controller.isRotating();
+    v.profiler = controller.getShowProfiler();
+    v.angle = controller.getRotationAngle();
+    v.cubies = cube.state();
+    return v;
+}
+
+void FrameScheduler::beginFrame(const Controller &controller)
+{
+    // 上一帧有变化时保持连续出帧：按住 WASD 等按键期间不会因等待事件而卡顿
+    // 上一帧处于等待模式时，EndDrawing / skipFrame 都可能阻塞了任意长的时间
+    blocked = waiting;
+    bool active = !controller.isIdle() || changed || dirty;
+    if (active == waiting)
+    {
+        waiting = !active;
+        if (waiting)
+            EnableEventWaiting();
+        else
+            DisableEventWaiting();
+    }
+    // 窗口创建之后才能查询显示器，所以在第一帧再决定
+    if (activeFps <= 0)
+    {
+        activeFps = GetMonitorRefreshRate(GetCurrentMonitor());
+        if (activeFps <= 0)
+            activeFps = 60;
+    }
+    int fps = activeFps;
+    if (fps != currentFps)
+    {
+        SetTargetFPS(fps);
+        currentFps = fps;
+    }
+}
+
+float FrameScheduler::frameTime()
+{
+    auto now = std::chrono::steady_clock::now();
+    float dt = blocked ? 0.0f : std::chrono::duration<float>(now - lastTick).count();
+    lastTick = now;
+    return dt;
+}
+
+bool FrameScheduler::needsRedraw(const Cube &cube, const Controller &controller)
+{
+    ViewState now = capture(cube, controller);
+    changed = !hasLast || !(now == last);
+    bool redraw = changed || dirty;
+    last = now;
+    hasLast = true;
+    dirty = false;
+    return redraw;
+}
+
+void FrameScheduler::skipFrame()
+{
+    // 不绘制时 EndDrawing 不会替我们处理输入，这里手动轮询；等待模式下阻塞到有新事件
+    PollInputEvents();
+    if (!waiting)
+        WaitTime(1.0 / (currentFps > 0 ? currentFps : 60));
+}
@@ -0,0 +1,44 @@
+#include "input.h"
+#include <raylib.h>
+#include <cctype>
+
+bool RaylibInput::isKeyDown(int key) const
+{
+    return IsKeyDown(key);
+}
+
+bool RaylibInput::isKeyPressed(int key) const
+{
+    return IsKeyPressed(key);
+}
+
+ScriptedInput::ScriptedInput(const std::string &script, bool loop)
+    : script(script), loop(loop), pos(0), current(0), waiting(false)
+{
+}
+
+void ScriptedInput::beginFrame()
+{
+    current = 0;
+    if (waiting)
+        return;
+    if (pos >= script.size())
+    {
+        if (!loop || script.empty())
+            return;
+        pos = 0;
+    }
+    char c = script[pos++];
+    switch (c)
+    {
+    case '<': current = KEY_LEFT; break;
+    case '>': current = KEY_RIGHT; break;
+    case '^': current = KEY_UP; break;
+    case 'v': current = KEY_DOWN; break;
+    case '_': waiting = true; break;
+    default:
+        if (isalpha((unsigned char)c))
+            current = KEY_A + (toupper((unsigned char)c) - 'A');
+        break;
+    }
+}
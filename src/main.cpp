@@ -1,20 +1,257 @@
 #include "cube.h"
 #include "controller.h"
 #include "renderer.h"
+#include "frame_scheduler.h"
+#include "profiler.h"
+#include "input.h"
+#include "move_log.h"
+#include "solution_cache.h"
+#include "solver.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace {
+
+struct Options {
+    bool headless = false;
+    long maxFrames = -1;          // 无窗口模式的最大帧数，-1 表示不限
+    std::string script = "R_U_";  // 无窗口模式的默认脚本：打乱、等待、求解、等待
+    bool loop = false;
+    std::string profileCsv;       // 退出时把帧计时写到该 CSV 文件
+    float turnsPerSecond = 4.0f;  // 动画速度
+    bool easing = true;
+    float fastForward = 0.0f;     // 待播放的转动超过该秒数时快进，0 表示关闭
+    std::string record;           // 把本次会话的转动记录到该日志文件
+    std::string replay;           // 回放该日志文件
+    long seek = 0;                // 回放从第几个转动开始
+    SolverEngine solver = SolverTwoPhase;
+    double solveBudget = 0.0;     // 求解的时间预算（秒），0 为引擎默认值
+    bool solutionCache = true;    // 求解结果缓存（SolutionCache）
+    bool scriptSet = false;
+};
+
+// 无窗口模式按固定步长推进动画，结果与机器快慢无关
+const float kHeadlessDt = 1.0f / 60.0f;
+
+bool parseArgs(int argc, char **argv, Options &opt)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(a, "--headless"))
+            opt.headless = true;
+        else if (!strcmp(a, "--frames") && hasValue)
+            opt.maxFrames = atol(argv[++i]);
+        else if (!strcmp(a, "--script") && hasValue)
+        {
+            opt.script = argv[++i];
+            opt.scriptSet = true;
+        }
+        else if (!strcmp(a, "--loop"))
+            opt.loop = true;
+        else if (!strcmp(a, "--profile-csv") && hasValue)
+            opt.profileCsv = argv[++i];
+        else if (!strcmp(a, "--tps") && hasValue)
+            opt.turnsPerSecond = (float)atof(argv[++i]);
+        else if (!strcmp(a, "--no-easing"))
+            opt.easing = false;
+        else if (!strcmp(a, "--fast-forward") && hasValue)
+            opt.fastForward = (float)atof(argv[++i]);
+        else if (!strcmp(a, "--record") && hasValue)
+            opt.record = argv[++i];
+        else if (!strcmp(a, "--replay") && hasValue)
+            opt.replay = argv[++i];
+        else if (!strcmp(a, "--seek") && hasValue)
+            opt.seek = atol(argv[++i]);
+        else if (!strcmp(a, "--solver") && hasValue)
+        {
+            const char *engine = argv[++i];
+            if (!strcmp(engine, "optimal"))
+                opt.solver = SolverOptimal;
+            else if (!strcmp(engine, "two-phase"))
+                opt.solver = SolverTwoPhase;
+            else if (!strcmp(engine, "portfolio"))
+                opt.solver = SolverPortfolio;
+            else if (!strcmp(engine, "anytime"))
+                opt.solver = SolverAnytime;
+            else
+                return false;
+        }
+        else if (!strcmp(a, "--solve-budget") && hasValue)
+            opt.solveBudget = atof(argv[++i]);
+        else if (!strcmp(a, "--no-solution-cache"))
+            opt.solutionCache = false;
+        else
+            return false;
+    }
+    // 回放时默认不再执行打乱/求解脚本
+    if (!opt.replay.empty() && !opt.scriptSet)
+        opt.script.clear();
+    return true;
+}
+
+// 转动日志：录制与回放（可以同时进行，回放出来的转动以 script 来源记录）
+struct Session {
+    MoveLogWriter log;
+    MoveLogReader reader;
+    std::unique_ptr<MoveLogPlayer> player;
+
+    bool open(const Options &opt, Cube &cube, Controller &controller)
+    {
+        if (!opt.replay.empty())
+        {
+            if (!reader.open(opt.replay))
+            {
+                fprintf(stderr, "[MoveLog] cannot read %s\n", opt.replay.c_str());
+                return false;
+            }
+            player.reset(new MoveLogPlayer(reader, cube, opt.seek > 0 ? (size_t)opt.seek : 0));
+            printf("[MoveLog] replaying %s: %zu moves, from %zu\n", opt.replay.c_str(), reader.size(),
+                   player->position());
+        }
+        if (!opt.record.empty())
+        {
+            if (!log.open(opt.record, cube.state()))
+            {
+                fprintf(stderr, "[MoveLog] cannot write %s\n", opt.record.c_str());
+                return false;
+            }
+            controller.setMoveLog(&log);
+        }
+        return true;
+    }
+    void feed(Controller &controller)
+    {
+        if (player)
+            player->feed(controller);
+    }
+    bool replayDone() const { return !player || player->finished(); }
+    void close(Controller &controller)
+    {
+        if (!log.isOpen())
+            return;
+        controller.setMoveLog(nullptr);
+        printf("[MoveLog] %zu moves written\n", log.moveCount());
+        log.close();
+    }
+};
+
+void configure(Controller &controller, const Options &opt)
+{
+    controller.setTurnsPerSecond(opt.turnsPerSecond);
+    controller.setEasing(opt.easing);
+    controller.setFastForward(opt.fastForward);
+    controller.setSolverEngine(opt.solver, opt.solveBudget);
+    SolutionCache::setEnabled(opt.solutionCache);
+}
+
+void dumpProfile(const Options &opt)
+{
+    if (opt.profileCsv.empty())
+        return;
+    if (Profiler::dumpCsv(opt.profileCsv))
+        printf("[Profiler] %zu frames written to %s\n", Profiler::count(), opt.profileCsv.c_str());
+    else
+        fprintf(stderr, "[Profiler] cannot write %s\n", opt.profileCsv.c_str());
+}
+
+// 无窗口模式：按脚本输入锁步推进，不做任何帧率限制
+int runHeadless(const Options &opt)
+{
+    Cube cube;
+    Controller controller;
+    configure(controller, opt);
+    NullRenderer renderer;
+    ScriptedInput input(opt.script, opt.loop);
+    Session session;
+    if (!session.open(opt, cube, controller))
+        return 1;
+
+    auto start = std::chrono::steady_clock::now();
+    while (opt.maxFrames < 0 || renderer.frameCount() < opt.maxFrames)
+    {
+        if (input.waitingForIdle() && controller.isIdle())
+            input.resume();
+        if (input.finished() && controller.isIdle() && session.replayDone())
+            break;
+        Profiler::beginFrame();
+        input.beginFrame();
+        session.feed(controller);
+        {
+            ProfileScope scope(ZoneUpdate);
+            controller.update(cube, input, kHeadlessDt);
+        }
+        renderer.drawFrame(cube, controller);
+        Profiler::endFrame();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("[Headless] %ld frames in %.3f s (%.0f frames/s)\n", renderer.frameCount(), seconds,
+           seconds > 0 ? (double)renderer.frameCount() / seconds : 0.0);
+    printf("[Headless] final state %s, %s\n", Solver::encodeFacelets(cube).c_str(),
+           cube.isSolved() ? "solved" : "not solved");
+    session.close(controller);
+    dumpProfile(opt);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt))
+    {
+        fprintf(stderr, "usage: Rubik3D [--profile-csv FILE] [--tps N] [--no-easing] [--fast-forward SECONDS] "
+                        "[--record FILE] [--replay FILE [--seek N]] "
+                        "[--solver two-phase|optimal|portfolio|anytime] [--solve-budget SECONDS] [--no-solution-cache] "
+                        "[--headless [--frames N] [--script KEYS] [--loop]]\n");
+        return 2;
+    }
+    if (opt.headless)
+        return runHeadless(opt);
 
-int main() {
     // 创建魔方对象、控制器和渲染器
     Cube cube;
     Controller controller;
+    configure(controller, opt);
     // Renderer renderer(800, 600);  // 窗口初始化，设置尺寸 800x600
     Renderer renderer(1280, 800);
+    RaylibInput input;
+    FrameScheduler scheduler;
+    Session session;
+    if (!session.open(opt, cube, controller))
+        return 1;
     
     // 主循环，直到窗口关闭
-    while (!WindowShouldClose()) {
+    while (!renderer.shouldClose()) {
+        scheduler.beginFrame(controller);
+        Profiler::beginFrame();
+        float dt = scheduler.frameTime();
+        session.feed(controller);
         // 更新输入和动画状态
-        controller.update(cube);
-        // 绘制当前帧
-        renderer.drawFrame(cube, controller);
+        {
+            ProfileScope scope(ZoneUpdate);
+            controller.update(cube, input, dt);
+        }
+        // 画面有变化才绘制，否则等待下一个输入事件
+        if (scheduler.needsRedraw(cube, controller))
+        {
+            renderer.drawFrame(cube, controller);
+            Profiler::endFrame();
+        }
+        else
+        {
+            // 先结束计时再等待事件：等待时长算进下一帧的帧间隔，不算本帧的 CPU 时间
+            Profiler::endFrame(false);
+            scheduler.skipFrame();
+        }
     }
+    session.close(controller);
+    dumpProfile(opt);
     return 0;
 }
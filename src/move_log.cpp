@@ -0,0 +1,293 @@
+#include "move_log.h"
+#include "controller.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char kMagic[8] = {'R', 'B', 'K', 'L', 'O', 'G', '0', '1'};
+const uint32_t kVersion = 1;
+const size_t kHeaderSize = 16;
+const uint8_t kCheckpointTag = 0x80;
+const size_t kCheckpointSize = 1 + 4 + 4 + 32;
+
+void putU32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i)
+        p[i] = (uint8_t)(v >> (8 * i));
+}
+
+uint32_t getU32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// 解析一条转动记录，成功时前移 p；记录不完整（录制中被截断）返回 false
+bool decodeMove(const uint8_t *&p, const uint8_t *end, MoveLogEntry &e, uint32_t &timeCs)
+{
+    if (p >= end || (*p & kCheckpointTag))
+        return false;
+    const uint8_t *q = p;
+    uint8_t head = *q++;
+    uint32_t delta = 0;
+    for (int shift = 0;; shift += 7)
+    {
+        if (q >= end || shift > 28)
+            return false;
+        uint8_t b = *q++;
+        delta |= (uint32_t)(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            break;
+    }
+    if ((head & 31) >= MoveCount)
+        return false;
+    timeCs += delta;
+    e.move = (MoveId)(head & 31);
+    e.source = (CommandSource)((head >> 5) & 3);
+    e.timeCs = timeCs;
+    p = q;
+    return true;
+}
+
+} // namespace
+
+MoveLogWriter::~MoveLogWriter()
+{
+    close();
+}
+
+bool MoveLogWriter::open(const std::string &path, const CubieState &initial, uint32_t checkpointInterval)
+{
+    close();
+    file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    interval = checkpointInterval > 0 ? checkpointInterval : kDefaultInterval;
+    count = 0;
+    lastCs = 0;
+    uint8_t header[kHeaderSize];
+    memcpy(header, kMagic, sizeof(kMagic));
+    putU32(header + 8, kVersion);
+    putU32(header + 12, interval);
+    fwrite(header, sizeof(header), 1, file);
+    writeCheckpoint(initial);
+    flush();
+    return true;
+}
+
+void MoveLogWriter::append(MoveId move, CommandSource source, double seconds, const CubieState &after)
+{
+    if (!file)
+        return;
+    uint32_t cs = seconds > 0 ? (uint32_t)std::llround(seconds * 100.0) : 0;
+    uint32_t delta = cs > lastCs ? cs - lastCs : 0;
+    lastCs += delta;
+    uint8_t buf[6];
+    size_t n = 0;
+    buf[n++] = (uint8_t)(move | (source & 3) << 5);
+    do
+    {
+        uint8_t b = delta & 0x7f;
+        delta >>= 7;
+        buf[n++] = delta ? (uint8_t)(b | 0x80) : b;
+    } while (delta);
+    fwrite(buf, 1, n, file);
+    if (++count % interval == 0)
+    {
+        writeCheckpoint(after);
+        // 检查点处刷新：读者最多落后一个检查点间隔
+        flush();
+    }
+}
+
+void MoveLogWriter::writeCheckpoint(const CubieState &state)
+{
+    uint8_t buf[kCheckpointSize];
+    buf[0] = kCheckpointTag;
+    putU32(buf + 1, (uint32_t)count);
+    putU32(buf + 5, lastCs);
+    memcpy(buf + 9, state.b, 32);
+    fwrite(buf, sizeof(buf), 1, file);
+}
+
+void MoveLogWriter::flush()
+{
+    if (file)
+        fflush(file);
+}
+
+void MoveLogWriter::close()
+{
+    if (!file)
+        return;
+    fclose(file);
+    file = nullptr;
+}
+
+MoveLogReader::~MoveLogReader()
+{
+    close();
+}
+
+bool MoveLogReader::open(const std::string &path)
+{
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < kHeaderSize + kCheckpointSize)
+    {
+        ::close(fd);
+        return false;
+    }
+    length = (size_t)st.st_size;
+    void *map = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+    {
+        length = 0;
+        return false;
+    }
+    data = static_cast<const uint8_t *>(map);
+    if (memcmp(data, kMagic, sizeof(kMagic)) != 0 || getU32(data + 8) != kVersion)
+    {
+        close();
+        return false;
+    }
+    checkpointInterval = getU32(data + 12);
+
+    // 扫描一遍：只记下检查点的位置，转动记录只解析长度
+    madvise(const_cast<uint8_t *>(data), length, MADV_SEQUENTIAL);
+    const uint8_t *p = data + kHeaderSize;
+    const uint8_t *end = data + length;
+    uint32_t timeCs = 0;
+    size_t moves = 0;
+    while (p < end)
+    {
+        if (*p == kCheckpointTag)
+        {
+            if ((size_t)(end - p) < kCheckpointSize)
+                break;
+            Checkpoint cp;
+            cp.index = getU32(p + 1);
+            cp.timeCs = getU32(p + 5);
+            memcpy(cp.state.b, p + 9, 32);
+            cp.offset = (size_t)(p - data) + kCheckpointSize;
+            if (cp.index != moves)
+                break;  // 与记录数对不上：文件损坏，到此为止
+            timeCs = cp.timeCs;
+            checkpoints.push_back(cp);
+            p += kCheckpointSize;
+            continue;
+        }
+        MoveLogEntry e;
+        if (!decodeMove(p, end, e, timeCs))
+            break;
+        ++moves;
+    }
+    moveCount = moves;
+    madvise(const_cast<uint8_t *>(data), length, MADV_RANDOM);
+    if (checkpoints.empty())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MoveLogReader::close()
+{
+    if (data)
+        munmap(const_cast<uint8_t *>(data), length);
+    data = nullptr;
+    length = 0;
+    moveCount = 0;
+    checkpoints.clear();
+}
+
+const MoveLogReader::Checkpoint &MoveLogReader::checkpointFor(size_t index) const
+{
+    // 检查点按 index 递增，找最后一个不大于 index 的
+    auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(), index,
+                               [](size_t i, const Checkpoint &cp) { return i < cp.index; });
+    return *(it - 1);
+}
+
+CubieState MoveLogReader::stateAt(size_t index) const
+{
+    if (index > moveCount)
+        index = moveCount;
+    const Checkpoint &cp = checkpointFor(index);
+    CubieState state = cp.state;
+    const uint8_t *p = data + cp.offset;
+    const uint8_t *end = data + length;
+    uint32_t timeCs = cp.timeCs;
+    for (size_t i = cp.index; i < index; ++i)
+    {
+        while (*p == kCheckpointTag)
+            p += kCheckpointSize;
+        MoveLogEntry e;
+        decodeMove(p, end, e, timeCs);
+        applyMove(state, e.move);
+    }
+    return state;
+}
+
+size_t MoveLogReader::read(size_t first, size_t n, std::vector<MoveLogEntry> &out) const
+{
+    out.clear();
+    if (first >= moveCount)
+        return 0;
+    n = std::min(n, moveCount - first);
+    const Checkpoint &cp = checkpointFor(first);
+    const uint8_t *p = data + cp.offset;
+    const uint8_t *end = data + length;
+    uint32_t timeCs = cp.timeCs;
+    for (size_t i = cp.index; i < first + n; ++i)
+    {
+        while (*p == kCheckpointTag)
+            p += kCheckpointSize;
+        MoveLogEntry e;
+        decodeMove(p, end, e, timeCs);
+        if (i >= first)
+            out.push_back(e);
+    }
+    return out.size();
+}
+
+MoveLogPlayer::MoveLogPlayer(const MoveLogReader &reader, Cube &cube, size_t start)
+    : reader(reader), next(std::min(start, reader.size())), bufferFirst(0)
+{
+    cube.setState(reader.stateAt(next));
+}
+
+void MoveLogPlayer::feed(Controller &controller)
+{
+    if (finished() || controller.isRotating() || !controller.getCommands().empty())
+        return;
+    // 按检查点间隔成块解码，避免每个转动都从检查点重新扫描
+    if (next < bufferFirst || next >= bufferFirst + buffer.size())
+    {
+        bufferFirst = next;
+        reader.read(next, reader.interval() > 0 ? reader.interval() : 256, buffer);
+    }
+    const MoveLogEntry &e = buffer[next - bufferFirst];
+    Axis axis;
+    int layer;
+    bool clockwise;
+    layerFromMove(e.move, axis, layer, clockwise);
+    // 指令里的 clockwise 是动画角度方向：X/Z 轴与 rotateLayer 的方向相反（见 getVisualClockwise）
+    if (axis != AxisY)
+        clockwise = !clockwise;
+    int times = movePower(e.move) == 1 ? 2 : 1;
+    MoveCommand cmd = {axis, (int8_t)layer, clockwise, SourceScript};
+    for (int i = 0; i < times; ++i)
+        controller.getCommands().push(cmd);
+    ++next;
+}
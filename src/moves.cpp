@@ -0,0 +1,631 @@
+#include "moves.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX512VBMI__) || defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// 位置 (x,y,z) 压缩为 0..26 的下标
+inline int posIndex(int x, int y, int z) { return x * 9 + y * 3 + z; }
+
+// 一个槽位（角/棱/中心）在立方体上的位置及其贴纸所在的面
+// 角块的三个面按统一的手性排列，保证任何整体旋转都只会把它们循环移位
+struct Slot {
+    int pos;
+    int count;
+    Face faces[3];
+};
+
+// 绕各轴顺时针旋转时面的循环：cycle[i] 转到 cycle[i+1]
+const Face kFaceCycle[3][4] = {
+    {FRONT, UP, BACK, DOWN},   // X
+    {FRONT, RIGHT, BACK, LEFT}, // Y
+    {LEFT, UP, RIGHT, DOWN},   // Z
+};
+
+// 每个转动族（U R F D L B M E S）的 90° 转动对应的 rotateLayer 参数
+struct LayerTurn {
+    Axis axis;
+    int layer;
+    bool clockwise;
+};
+const LayerTurn kFamilyTurn[9] = {
+    {AxisY, 2, false}, // U
+    {AxisX, 2, true},  // R
+    {AxisZ, 2, true},  // F
+    {AxisY, 0, true},  // D
+    {AxisX, 0, false}, // L
+    {AxisZ, 0, false}, // B
+    {AxisX, 1, false}, // M
+    {AxisY, 1, true},  // E
+    {AxisZ, 1, true},  // S
+};
+
+const char *const kMoveNames[MoveCount] = {
+    "U", "U2", "U'", "R", "R2", "R'", "F", "F2", "F'",
+    "D", "D2", "D'", "L", "L2", "L'", "B", "B2", "B'",
+    "M", "M2", "M'", "E", "E2", "E'", "S", "S2", "S'",
+};
+
+// 把一张贴纸（位置+面）绕 axis 旋转 90 度，与旧版指针旋转的方向约定一致
+void turnSticker(Axis axis, bool clockwise, int c[3], Face &face)
+{
+    // 该轴之外的两个坐标 (u,v)：顺时针 (u,v)->(v,2-u)，逆时针 (u,v)->(2-v,u)
+    int u = axis == AxisX ? 1 : 0;
+    int v = axis == AxisZ ? 1 : 2;
+    int ou = c[u], ov = c[v];
+    if (clockwise)
+    {
+        c[u] = ov;
+        c[v] = 2 - ou;
+    }
+    else
+    {
+        c[u] = 2 - ov;
+        c[v] = ou;
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        if (kFaceCycle[axis][i] == face)
+        {
+            face = kFaceCycle[axis][(i + (clockwise ? 1 : 3)) % 4];
+            break;
+        }
+    }
+}
+
+// 把贴纸按 move 的逆转动倒推一步（只有位于转动层上的贴纸会动）
+void untwistSticker(MoveId move, int c[3], Face &face)
+{
+    const LayerTurn &t = kFamilyTurn[moveFace(move)];
+    if (c[t.axis] != t.layer)
+        return;
+    int times = movePower(move) == 1 ? 2 : 1;
+    bool back = movePower(move) == 2 ? t.clockwise : !t.clockwise;
+    for (int i = 0; i < times; ++i)
+        turnSticker(t.axis, back, c, face);
+}
+
+// facelet 序号（URFDLB，每面按行从左上到右下）对应的位置与面
+void faceletLocation(int index, int c[3], Face &face)
+{
+    static const Face order[6] = {UP, RIGHT, FRONT, DOWN, LEFT, BACK};
+    face = order[index / 9];
+    int i = index % 9 / 3, j = index % 3;
+    switch (face)
+    {
+    case UP:    c[0] = j;     c[1] = 2;     c[2] = i;     break;
+    case DOWN:  c[0] = j;     c[1] = 0;     c[2] = 2 - i; break;
+    case LEFT:  c[0] = 0;     c[1] = 2 - i; c[2] = j;     break;
+    case RIGHT: c[0] = 2;     c[1] = 2 - i; c[2] = 2 - j; break;
+    case FRONT: c[0] = j;     c[1] = 2 - i; c[2] = 2;     break;
+    case BACK:  c[0] = 2 - j; c[1] = 2 - i; c[2] = 0;     break;
+    }
+}
+
+// 所有几何查表：启动时由立方体几何推导一次，之后每次转动只做查表
+struct MoveTables {
+    Slot corners[8];
+    Slot edges[12];
+    Slot centers[6];
+    // 位置 -> CubieState 中对应槽位的字节下标（核心块为 -1）
+    int8_t slotByte[27];
+    // 位置 + 面 -> 该贴纸在槽位中的序号（无贴纸为 -1）
+    int8_t faceletIndex[27][6];
+    // 位置 + 面 -> facelet 序号（无贴纸为 -1）
+    int8_t faceletOf[27][6];
+
+    // 小块状态的转动表：new.b[i] = old.b[perm[i]] + delta[i]，不小于 mod[i] 时减去 mod[i]
+    // 角块/中心块只在低 16 字节内置换、棱块只在高 16 字节内置换，
+    // 因此 perm 的低 4 位可以直接作为 pshufb 的通道内下标
+    alignas(32) uint8_t perm[MoveCount][32];
+    alignas(32) uint8_t delta[MoveCount][32];
+    alignas(32) uint8_t mod[32];
+
+    // 贴纸数组的转动表：new.f[i] = old.f[facelet[i]]
+    alignas(64) uint8_t facelet[MoveCount][64];
+    // SSSE3 / NEON 路径用：对每个 16 字节输出块，分别从 4 个输入块取数的 pshufb 下标（不取为 0x80）
+    alignas(16) uint8_t faceletLane[MoveCount][4][4][16];
+    // 标量路径用：每个转动实际改动的字节（小块最多 12 个，贴纸最多 21 个）
+    uint8_t cubieTouched[MoveCount][12];
+    uint8_t cubieTouchedCount[MoveCount];
+    uint8_t faceletTouched[MoveCount][21];
+    uint8_t faceletTouchedCount[MoveCount];
+    // facelet -> 状态字节，以及该字节取值 -> 贴纸原本所属的面（stickerHome 的展开表）
+    uint8_t faceletByte[54];
+    alignas(16) uint8_t faceletHome[54][32];
+
+    MoveTables()
+    {
+        memset(slotByte, -1, sizeof(slotByte));
+        memset(faceletIndex, -1, sizeof(faceletIndex));
+        memset(faceletOf, -1, sizeof(faceletOf));
+        int nc = 0, ne = 0, nm = 0;
+        for (int x = 0; x < 3; ++x)
+            for (int y = 0; y < 3; ++y)
+                for (int z = 0; z < 3; ++z)
+                {
+                    int p = posIndex(x, y, z);
+                    int sx = x - 1, sy = y - 1, sz = z - 1;
+                    Face fx = sx < 0 ? LEFT : RIGHT;
+                    Face fy = sy < 0 ? DOWN : UP;
+                    Face fz = sz < 0 ? BACK : FRONT;
+                    Slot s = {p, 0, {LEFT, LEFT, LEFT}};
+                    int outer = (sx != 0) + (sy != 0) + (sz != 0);
+                    if (outer == 3)
+                    {
+                        // 角块：U/D 面在前，其余两面按同一手性排列
+                        s.count = 3;
+                        s.faces[0] = fy;
+                        s.faces[1] = sx * sy * sz > 0 ? fz : fx;
+                        s.faces[2] = sx * sy * sz > 0 ? fx : fz;
+                        slotByte[p] = CubieState::kCornerOffset + nc;
+                        corners[nc++] = s;
+                    }
+                    else if (outer == 2)
+                    {
+                        // 棱块：有 U/D 面时以其为参考面，否则以 F/B 面为参考面
+                        s.count = 2;
+                        if (sy != 0)
+                        {
+                            s.faces[0] = fy;
+                            s.faces[1] = sx != 0 ? fx : fz;
+                        }
+                        else
+                        {
+                            s.faces[0] = fz;
+                            s.faces[1] = fx;
+                        }
+                        slotByte[p] = CubieState::kEdgeOffset + ne;
+                        edges[ne++] = s;
+                    }
+                    else if (outer == 1)
+                    {
+                        s.count = 1;
+                        s.faces[0] = sx != 0 ? fx : (sy != 0 ? fy : fz);
+                        slotByte[p] = CubieState::kCenterOffset + nm;
+                        centers[nm++] = s;
+                    }
+                    for (int k = 0; k < s.count; ++k)
+                        faceletIndex[p][s.faces[k]] = (int8_t)k;
+                }
+
+        for (int i = 0; i < 54; ++i)
+        {
+            int c[3];
+            Face f;
+            faceletLocation(i, c, f);
+            faceletOf[posIndex(c[0], c[1], c[2])][f] = (int8_t)i;
+        }
+
+        for (int i = 0; i < 32; ++i)
+            mod[i] = i < CubieState::kEdgeOffset ? 24 : 32;
+
+        for (int i = 0; i < 54; ++i)
+        {
+            int c[3];
+            Face f;
+            faceletLocation(i, c, f);
+            int p = posIndex(c[0], c[1], c[2]);
+            faceletByte[i] = (uint8_t)slotByte[p];
+            for (int v = 0; v < 32; ++v)
+                faceletHome[i][v] = (uint8_t)homeOf(p, f, (uint8_t)v);
+        }
+
+        for (int m = 0; m < MoveCount; ++m)
+        {
+            buildCubieMove((MoveId)m);
+            buildFaceletMove((MoveId)m);
+        }
+    }
+
+    // 槽位 p 的 face 面上的贴纸，在该槽位字节取值为 v 时原本所属的面（越界取值给 0）
+    int homeOf(int p, Face face, uint8_t v) const
+    {
+        int k = faceletIndex[p][face];
+        int byte = slotByte[p];
+        if (byte < CubieState::kCenterOffset)
+            return (v >> 3) < 3 ? corners[v & 7].faces[(k + 3 - (v >> 3)) % 3] : 0;
+        if (byte < CubieState::kEdgeOffset)
+            return v < 6 ? centers[v].faces[0] : 0;
+        return (v & 15) < 12 ? edges[v & 15].faces[(k + (v >> 4)) & 1] : 0;
+    }
+
+    void buildCubieMove(MoveId move)
+    {
+        uint8_t *pm = perm[move];
+        uint8_t *dm = delta[move];
+        for (int i = 0; i < 32; ++i)
+        {
+            pm[i] = (uint8_t)i;
+            dm[i] = 0;
+        }
+        auto fill = [&](const Slot *slots, int n, int unit) {
+            for (int j = 0; j < n; ++j)
+            {
+                const Slot &dst = slots[j];
+                int c[3] = {dst.pos / 9, dst.pos / 3 % 3, dst.pos % 3};
+                // 倒推目标槽位的参考贴纸，找到它转动前所在的槽位与贴纸序号
+                Face f = dst.faces[0];
+                untwistSticker(move, c, f);
+                int src = posIndex(c[0], c[1], c[2]);
+                int k = faceletIndex[src][f];
+                pm[slotByte[dst.pos]] = (uint8_t)slotByte[src];
+                dm[slotByte[dst.pos]] = (uint8_t)(((dst.count - k) % dst.count) * unit);
+            }
+        };
+        fill(corners, 8, 8);
+        fill(edges, 12, 16);
+        fill(centers, 6, 0);
+
+        uint8_t n = 0;
+        for (int i = 0; i < 32; ++i)
+            if (pm[i] != i || dm[i] != 0)
+                cubieTouched[move][n++] = (uint8_t)i;
+        cubieTouchedCount[move] = n;
+    }
+
+    void buildFaceletMove(MoveId move)
+    {
+        uint8_t *fm = facelet[move];
+        for (int i = 0; i < 64; ++i)
+            fm[i] = (uint8_t)i;
+        for (int i = 0; i < 54; ++i)
+        {
+            int c[3];
+            Face f;
+            faceletLocation(i, c, f);
+            untwistSticker(move, c, f);
+            fm[i] = (uint8_t)faceletOf[posIndex(c[0], c[1], c[2])][f];
+        }
+        uint8_t n = 0;
+        for (int i = 0; i < 54; ++i)
+            if (fm[i] != i)
+                faceletTouched[move][n++] = (uint8_t)i;
+        faceletTouchedCount[move] = n;
+        for (int out = 0; out < 4; ++out)
+            for (int in = 0; in < 4; ++in)
+                for (int k = 0; k < 16; ++k)
+                {
+                    int src = fm[out * 16 + k];
+                    faceletLane[move][out][in][k] = src / 16 == in ? (uint8_t)(src % 16) : 0x80;
+                }
+    }
+};
+
+const MoveTables &tables()
+{
+    static const MoveTables t;
+    return t;
+}
+
+} // namespace
+
+const char *moveName(MoveId move)
+{
+    return move < MoveCount ? kMoveNames[move] : "?";
+}
+
+bool parseMove(const char *text, MoveId &move)
+{
+    static const char kFamilies[] = "URFDLBMES";
+    const char *p = strchr(kFamilies, text[0]);
+    if (text[0] == '\0' || p == nullptr)
+        return false;
+    int power;
+    if (text[1] == '\0')
+        power = 0;
+    else if (text[1] == '2' && text[2] == '\0')
+        power = 1;
+    else if (text[1] == '\'' && text[2] == '\0')
+        power = 2;
+    else
+        return false;
+    move = static_cast<MoveId>((p - kFamilies) * 3 + power);
+    return true;
+}
+
+MoveId moveFromLayer(Axis axis, int layer, bool clockwise)
+{
+    // [axis][layer][clockwise]，与 kFamilyTurn 互逆
+    static const MoveId kLayerMove[3][3][2] = {
+        {{MoveL, MoveLPrime}, {MoveM, MoveMPrime}, {MoveRPrime, MoveR}},
+        {{MoveDPrime, MoveD}, {MoveEPrime, MoveE}, {MoveU, MoveUPrime}},
+        {{MoveB, MoveBPrime}, {MoveSPrime, MoveS}, {MoveFPrime, MoveF}},
+    };
+    return kLayerMove[axis][layer][clockwise];
+}
+
+void layerFromMove(MoveId move, Axis &axis, int &layer, bool &clockwise)
+{
+    const LayerTurn &t = kFamilyTurn[moveFace(move)];
+    axis = t.axis;
+    layer = t.layer;
+    clockwise = movePower(move) == 2 ? !t.clockwise : t.clockwise;
+}
+
+size_t simplifyMoves(std::vector<MoveId> &moves)
+{
+    // 原地改写：moves[0, n) 为已化简的前缀，其中任意一段同轴转动里每个面最多出现一次
+    size_t n = 0;
+    for (size_t i = 0; i < moves.size(); ++i)
+    {
+        MoveId move = moves[i];
+        int face = moveFace(move);
+        Axis axis = kFamilyTurn[face].axis;
+        // 同轴的层互不干扰可以交换，向前越过它们找同一面
+        size_t j = n;
+        bool merged = false;
+        while (j > 0 && kFamilyTurn[moveFace(moves[j - 1])].axis == axis)
+        {
+            --j;
+            if (moveFace(moves[j]) != face)
+                continue;
+            // 幂次 + 1 即 90° 的个数，相加模 4
+            int quarters = (movePower(moves[j]) + movePower(move) + 2) % 4;
+            if (quarters == 0)
+            {
+                std::copy(moves.begin() + j + 1, moves.begin() + n, moves.begin() + j);
+                --n;
+            }
+            else
+                moves[j] = static_cast<MoveId>(face * 3 + quarters - 1);
+            merged = true;
+            break;
+        }
+        if (!merged)
+            moves[n++] = move;
+    }
+    size_t removed = moves.size() - n;
+    moves.resize(n);
+    return removed;
+}
+
+void invertMoves(std::vector<MoveId> &moves)
+{
+    std::reverse(moves.begin(), moves.end());
+    for (MoveId &m : moves)
+        m = inverseMove(m);
+}
+
+void applyMove(CubieState &state, MoveId move)
+{
+    const MoveTables &t = tables();
+#if defined(__AVX2__)
+    // 两个 128 位通道各自 pshufb，一条指令完成全部置换；朝向相加后用 min(v, v-mod) 取模
+    __m256i s = _mm256_load_si256(reinterpret_cast<const __m256i *>(state.b));
+    __m256i p = _mm256_load_si256(reinterpret_cast<const __m256i *>(t.perm[move]));
+    __m256i d = _mm256_load_si256(reinterpret_cast<const __m256i *>(t.delta[move]));
+    __m256i m = _mm256_load_si256(reinterpret_cast<const __m256i *>(t.mod));
+    s = _mm256_add_epi8(_mm256_shuffle_epi8(s, p), d);
+    s = _mm256_min_epu8(s, _mm256_sub_epi8(s, m));
+    _mm256_store_si256(reinterpret_cast<__m256i *>(state.b), s);
+#elif defined(__SSSE3__)
+    for (int h = 0; h < 32; h += 16)
+    {
+        __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(state.b + h));
+        __m128i p = _mm_and_si128(_mm_load_si128(reinterpret_cast<const __m128i *>(t.perm[move] + h)), _mm_set1_epi8(15));
+        __m128i d = _mm_load_si128(reinterpret_cast<const __m128i *>(t.delta[move] + h));
+        __m128i m = _mm_load_si128(reinterpret_cast<const __m128i *>(t.mod + h));
+        s = _mm_add_epi8(_mm_shuffle_epi8(s, p), d);
+        s = _mm_min_epu8(s, _mm_sub_epi8(s, m));
+        _mm_store_si128(reinterpret_cast<__m128i *>(state.b + h), s);
+    }
+#elif defined(__ARM_NEON)
+    for (int h = 0; h < 32; h += 16)
+    {
+        uint8x16_t s = vld1q_u8(state.b + h);
+        uint8x16_t p = vandq_u8(vld1q_u8(t.perm[move] + h), vdupq_n_u8(15));
+        s = vaddq_u8(vqtbl1q_u8(s, p), vld1q_u8(t.delta[move] + h));
+        s = vminq_u8(s, vsubq_u8(s, vld1q_u8(t.mod + h)));
+        vst1q_u8(state.b + h, s);
+    }
+#else
+    // 标量：只搬移该转动涉及的字节
+    const uint8_t *idx = t.cubieTouched[move];
+    int n = t.cubieTouchedCount[move];
+    uint8_t moved[12];
+    for (int k = 0; k < n; ++k)
+    {
+        int i = idx[k];
+        uint8_t v = (uint8_t)(state.b[t.perm[move][i]] + t.delta[move][i]);
+        moved[k] = v >= t.mod[i] ? (uint8_t)(v - t.mod[i]) : v;
+    }
+    for (int k = 0; k < n; ++k)
+        state.b[idx[k]] = moved[k];
+#endif
+}
+
+void applyMove(FaceletState &state, MoveId move)
+{
+    const MoveTables &t = tables();
+#if defined(__AVX512VBMI__)
+    // 64 字节任意置换：单条 vpermb
+    __m512i s = _mm512_load_si512(state.f);
+    __m512i p = _mm512_load_si512(t.facelet[move]);
+    _mm512_store_si512(state.f, _mm512_permutexvar_epi8(p, s));
+#elif defined(__SSSE3__)
+    // 每个输出块 = 4 个输入块各自 pshufb 后按位或
+    __m128i in[4], out[4];
+    for (int k = 0; k < 4; ++k)
+        in[k] = _mm_load_si128(reinterpret_cast<const __m128i *>(state.f + k * 16));
+    for (int o = 0; o < 4; ++o)
+    {
+        const uint8_t(*lane)[16] = t.faceletLane[move][o];
+        __m128i r = _mm_shuffle_epi8(in[0], _mm_load_si128(reinterpret_cast<const __m128i *>(lane[0])));
+        r = _mm_or_si128(r, _mm_shuffle_epi8(in[1], _mm_load_si128(reinterpret_cast<const __m128i *>(lane[1]))));
+        r = _mm_or_si128(r, _mm_shuffle_epi8(in[2], _mm_load_si128(reinterpret_cast<const __m128i *>(lane[2]))));
+        r = _mm_or_si128(r, _mm_shuffle_epi8(in[3], _mm_load_si128(reinterpret_cast<const __m128i *>(lane[3]))));
+        out[o] = r;
+    }
+    for (int k = 0; k < 4; ++k)
+        _mm_store_si128(reinterpret_cast<__m128i *>(state.f + k * 16), out[k]);
+#elif defined(__ARM_NEON)
+    // 64 字节查表：每 16 字节输出一条 tbl
+    uint8x16x4_t s = vld1q_u8_x4(state.f);
+    for (int o = 0; o < 64; o += 16)
+        vst1q_u8(state.f + o, vqtbl4q_u8(s, vld1q_u8(t.facelet[move] + o)));
+#else
+    const uint8_t *idx = t.faceletTouched[move];
+    int n = t.faceletTouchedCount[move];
+    uint8_t moved[21];
+    for (int k = 0; k < n; ++k)
+        moved[k] = state.f[t.facelet[move][idx[k]]];
+    for (int k = 0; k < n; ++k)
+        state.f[idx[k]] = moved[k];
+#endif
+}
+
+void applySequence(CubieState &state, const MoveId *moves, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        applyMove(state, moves[i]);
+}
+
+int slotByte(int x, int y, int z)
+{
+    return tables().slotByte[posIndex(x, y, z)];
+}
+
+int stickerHome(const CubieState &state, int x, int y, int z, Face face)
+{
+    const MoveTables &t = tables();
+    int p = posIndex(x, y, z);
+    if (t.faceletIndex[p][face] < 0)
+        return -1;
+    return t.homeOf(p, face, state.b[t.slotByte[p]]);
+}
+
+void stickerHomes(const CubieState &state, uint8_t homes[54])
+{
+    const MoveTables &t = tables();
+    for (int i = 0; i < 54; ++i)
+        homes[i] = t.faceletHome[i][state.b[t.faceletByte[i]] & 31];
+}
+
+CubieMoveView cubieMoveView(MoveId move)
+{
+    const MoveTables &t = tables();
+    return {t.perm[move], t.delta[move], t.mod, t.cubieTouched[move], t.cubieTouchedCount[move]};
+}
+
+FaceletSource faceletSource(int facelet)
+{
+    const MoveTables &t = tables();
+    return {t.faceletByte[facelet], t.faceletHome[facelet]};
+}
+
+CubieState solvedCubieState()
+{
+    CubieState s;
+    memset(s.b, 0, sizeof(s.b));
+    for (int i = 0; i < 8; ++i)
+        s.b[CubieState::kCornerOffset + i] = (uint8_t)i;
+    for (int i = 0; i < 6; ++i)
+        s.b[CubieState::kCenterOffset + i] = (uint8_t)i;
+    for (int i = 0; i < 12; ++i)
+        s.b[CubieState::kEdgeOffset + i] = (uint8_t)i;
+    return s;
+}
+
+const std::vector<std::vector<MoveId>> &cubeRotations()
+{
+    // 从恒等出发按 x / y 广度优先，以中心块的排列区分朝向
+    static const std::vector<std::vector<MoveId>> rotations = [] {
+        std::vector<std::vector<MoveId>> out = {{}};
+        std::vector<CubieState> states = {solvedCubieState()};
+        for (size_t i = 0; i < out.size(); ++i)
+        {
+            for (Axis axis : {AxisX, AxisY})
+            {
+                std::vector<MoveId> seq = out[i];
+                CubieState s = states[i];
+                for (int layer = 0; layer < 3; ++layer)
+                {
+                    MoveId m = moveFromLayer(axis, layer, true);
+                    seq.push_back(m);
+                    applyMove(s, m);
+                }
+                bool known = false;
+                for (const CubieState &t : states)
+                    known = known || memcmp(t.b + CubieState::kCenterOffset, s.b + CubieState::kCenterOffset, 6) == 0;
+                if (!known)
+                {
+                    out.push_back(seq);
+                    states.push_back(s);
+                }
+            }
+        }
+        return out;
+    }();
+    return rotations;
+}
+
+const std::vector<MoveId> *centerRotation(const CubieState &state)
+{
+    for (const std::vector<MoveId> &rotation : cubeRotations())
+    {
+        CubieState s = state;
+        applySequence(s, rotation.data(), rotation.size());
+        bool home = true;
+        for (int i = 0; i < 6; ++i)
+            home = home && s.b[CubieState::kCenterOffset + i] == i;
+        if (home)
+            return &rotation;
+    }
+    return nullptr;
+}
+
+void conjugateMoves(std::vector<MoveId> &moves, const std::vector<MoveId> &rotation)
+{
+    if (rotation.empty())
+        return;
+    std::vector<MoveId> inverse = rotation;
+    invertMoves(inverse);
+    const CubieState solved = solvedCubieState();
+    CubieState faceMoves[MoveFaceCount];
+    for (int k = 0; k < MoveFaceCount; ++k)
+    {
+        faceMoves[k] = solved;
+        applyMove(faceMoves[k], (MoveId)k);
+    }
+    MoveId map[MoveFaceCount];
+    for (int m = 0; m < MoveFaceCount; ++m)
+    {
+        CubieState c = solved;
+        applySequence(c, rotation.data(), rotation.size());
+        applyMove(c, (MoveId)m);
+        applySequence(c, inverse.data(), inverse.size());
+        map[m] = (MoveId)m;
+        for (int k = 0; k < MoveFaceCount; ++k)
+            if (faceMoves[k] == c)
+                map[m] = (MoveId)k;
+    }
+    for (MoveId &m : moves)
+        if (m < MoveFaceCount)
+            m = map[m];
+}
+
+CubieState inverseState(const CubieState &state)
+{
+    CubieState inv;
+    memset(inv.b, 0, sizeof(inv.b));
+    for (int i = 0; i < 8; ++i)
+    {
+        uint8_t v = state.b[CubieState::kCornerOffset + i];
+        inv.b[CubieState::kCornerOffset + (v & 7)] = (uint8_t)(i + (3 - (v >> 3)) % 3 * 8);
+    }
+    for (int i = 0; i < 6; ++i)
+        inv.b[CubieState::kCenterOffset + state.b[CubieState::kCenterOffset + i]] = (uint8_t)i;
+    for (int i = 0; i < 12; ++i)
+    {
+        uint8_t v = state.b[CubieState::kEdgeOffset + i];
+        inv.b[CubieState::kEdgeOffset + (v & 15)] = (uint8_t)(i + (v >> 4) * 16);
+    }
+    return inv;
+}
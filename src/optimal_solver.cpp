@@ -0,0 +1,544 @@
+#include "optimal_solver.h"
+#include "table_cache.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t kCornerEntries = 40320ull * 2187; // 8! * 3^7
+const size_t kEdgeEntries = 665280ull * 64;    // 12!/6! * 2^6
+const uint8_t kUnknown = 15;                   // 生成过程中尚未到达的项
+const int kMaxDepth = 20;                      // 任何状态都能在 20 步（HTM）内复原
+const int kSplitDepth = 3;                     // 根展开的层数，每个前缀是一份可领取的工作
+
+// 缓存文件：64 字节文件头，之后依次是角块表、棱块 0..5 表、棱块 6..11 表（各自 4 位一项）
+const char kMagic[8] = {'R', 'B', 'K', 'P', 'D', 'B', '0', '1'};
+const uint32_t kVersion = 1;
+const size_t kHeaderSize = 64;
+
+struct PdbHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t entries[3];
+};
+
+size_t tableBytes(size_t entries) { return (entries + 1) / 2; }
+
+const size_t kFileSize = kHeaderSize + tableBytes(kCornerEntries) + 2 * tableBytes(kEdgeEntries);
+
+struct Tables {
+    const uint8_t *corners;
+    const uint8_t *edgesLow;  // 棱块 0..5
+    const uint8_t *edgesHigh; // 棱块 6..11
+};
+
+Tables tables;
+std::vector<uint8_t> heapTables; // 缓存写不进磁盘时，表留在这里
+std::atomic<bool> ready{false};
+std::once_flag once;
+
+inline int nibble(const uint8_t *t, size_t i) { return (t[i >> 1] >> ((i & 1) * 4)) & 15; }
+
+// used 中第 n 个为 0 的位
+inline uint32_t nthFree(uint32_t used, uint32_t n)
+{
+    for (uint32_t slot = 0;; ++slot)
+        if (!(used >> slot & 1) && n-- == 0)
+            return slot;
+}
+
+// 角块：按块编号列出所在槽位，取其 Lehmer 码；朝向取块 0..6 的（块 7 由总和为 0 决定）
+inline uint32_t cornerIndex(const CubieState &s)
+{
+    uint8_t slotOf[8], oriOf[8];
+    for (int slot = 0; slot < 8; ++slot)
+    {
+        uint8_t v = s.b[CubieState::kCornerOffset + slot];
+        slotOf[v & 7] = (uint8_t)slot;
+        oriOf[v & 7] = (uint8_t)(v >> 3);
+    }
+    uint32_t used = 0, perm = 0, ori = 0;
+    for (int k = 0; k < 8; ++k)
+    {
+        uint32_t p = slotOf[k];
+        perm = perm * (uint32_t)(8 - k) + p - (uint32_t)__builtin_popcount(used & ((1u << p) - 1));
+        used |= 1u << p;
+    }
+    for (int k = 0; k < 7; ++k)
+        ori = ori * 3 + oriOf[k];
+    return perm * 2187 + ori;
+}
+
+void cornerState(uint32_t index, CubieState &s)
+{
+    uint32_t ori = index % 2187, perm = index / 2187;
+    uint8_t o[8];
+    int twist = 0;
+    for (int k = 6; k >= 0; --k)
+    {
+        o[k] = (uint8_t)(ori % 3);
+        ori /= 3;
+        twist += o[k];
+    }
+    o[7] = (uint8_t)((3 - twist % 3) % 3);
+    uint32_t digit[8];
+    for (int k = 7; k >= 0; --k)
+    {
+        digit[k] = perm % (uint32_t)(8 - k);
+        perm /= (uint32_t)(8 - k);
+    }
+    uint32_t used = 0;
+    for (int k = 0; k < 8; ++k)
+    {
+        uint32_t slot = nthFree(used, digit[k]);
+        used |= 1u << slot;
+        s.b[CubieState::kCornerOffset + slot] = (uint8_t)(k + o[k] * 8);
+    }
+}
+
+// 棱块 first..first+5：按块编号列出所在槽位（12 选 6 的有序排列）与各自的朝向
+inline uint32_t edgeIndex(const CubieState &s, uint32_t first)
+{
+    uint8_t slotOf[6], oriOf[6];
+    for (int slot = 0; slot < 12; ++slot)
+    {
+        uint8_t v = s.b[CubieState::kEdgeOffset + slot];
+        uint32_t k = (uint32_t)(v & 15) - first;
+        if (k < 6)
+        {
+            slotOf[k] = (uint8_t)slot;
+            oriOf[k] = (uint8_t)(v >> 4);
+        }
+    }
+    uint32_t used = 0, perm = 0, ori = 0;
+    for (int k = 0; k < 6; ++k)
+    {
+        uint32_t p = slotOf[k];
+        perm = perm * (uint32_t)(12 - k) + p - (uint32_t)__builtin_popcount(used & ((1u << p) - 1));
+        used |= 1u << p;
+        ori = ori * 2 + oriOf[k];
+    }
+    return perm * 64 + ori;
+}
+
+// 不在这一组的棱块写成编号 15：转动内核照常搬动它们，edgeIndex 会忽略
+void edgeState(uint32_t index, uint32_t first, CubieState &s)
+{
+    uint32_t ori = index % 64, perm = index / 64;
+    memset(s.b + CubieState::kEdgeOffset, 15, 12);
+    uint32_t digit[6];
+    for (int k = 5; k >= 0; --k)
+    {
+        digit[k] = perm % (uint32_t)(12 - k);
+        perm /= (uint32_t)(12 - k);
+    }
+    uint32_t used = 0;
+    for (int k = 0; k < 6; ++k)
+    {
+        uint32_t slot = nthFree(used, digit[k]);
+        used |= 1u << slot;
+        uint32_t o = ori >> (5 - k) & 1;
+        s.b[CubieState::kEdgeOffset + slot] = (uint8_t)(first + (uint32_t)k + o * 16);
+    }
+}
+
+uint32_t edgeLowIndex(const CubieState &s) { return edgeIndex(s, 0); }
+uint32_t edgeHighIndex(const CubieState &s) { return edgeIndex(s, 6); }
+void edgeLowState(uint32_t i, CubieState &s) { edgeState(i, 0, s); }
+void edgeHighState(uint32_t i, CubieState &s) { edgeState(i, 6, s); }
+
+struct Pattern {
+    const char *name;
+    size_t entries;
+    uint32_t (*index)(const CubieState &);
+    void (*state)(uint32_t, CubieState &);
+};
+
+const Pattern kPatterns[3] = {
+    {"corners", kCornerEntries, cornerIndex, cornerState},
+    {"edges 0-5", kEdgeEntries, edgeLowIndex, edgeLowState},
+    {"edges 6-11", kEdgeEntries, edgeHighIndex, edgeHighState},
+};
+
+// 把尚未到达的项设为 depth；同一字节的两个半字节可能被不同线程同时写，用 CAS
+inline bool claim(uint8_t *table, size_t i, uint8_t depth)
+{
+    uint8_t *p = table + (i >> 1);
+    int shift = (int)(i & 1) * 4;
+    uint8_t old = __atomic_load_n(p, __ATOMIC_RELAXED);
+    while ((old >> shift & 15) == kUnknown)
+    {
+        uint8_t value = (uint8_t)((old & ~(15 << shift)) | depth << shift);
+        if (__atomic_compare_exchange_n(p, &old, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            return true;
+    }
+    return false;
+}
+
+// 逐层 BFS：每层所有线程分块扫描整张表，展开深度为 depth 的项，新到达的项记为 depth + 1
+void buildPattern(const Pattern &p, uint8_t *table, ThreadPool &pool)
+{
+    const size_t kChunk = 1 << 16;
+    Clock::time_point t0 = Clock::now();
+    memset(table, 0xFF, tableBytes(p.entries));
+    const CubieState solved = solvedCubieState();
+    claim(table, p.index(solved), 0);
+    int depth = 0;
+    for (;; ++depth)
+    {
+        std::atomic<size_t> nextChunk{0};
+        std::atomic<size_t> added{0};
+        std::vector<std::future<void>> tasks;
+        for (size_t t = 0; t < pool.size(); ++t)
+            tasks.push_back(pool.submit([&] {
+                CubieState s = solved;
+                size_t local = 0;
+                for (size_t c = nextChunk.fetch_add(1); c * kChunk < p.entries; c = nextChunk.fetch_add(1))
+                {
+                    size_t end = std::min(p.entries, (c + 1) * kChunk);
+                    for (size_t i = c * kChunk; i < end; ++i)
+                    {
+                        if ((__atomic_load_n(table + (i >> 1), __ATOMIC_RELAXED) >> ((i & 1) * 4) & 15) != depth)
+                            continue;
+                        p.state((uint32_t)i, s);
+                        for (int m = 0; m < MoveFaceCount; ++m)
+                        {
+                            CubieState n = s;
+                            applyMove(n, (MoveId)m);
+                            if (claim(table, p.index(n), (uint8_t)(depth + 1)))
+                                ++local;
+                        }
+                    }
+                }
+                added.fetch_add(local);
+            }));
+        for (auto &f : tasks)
+            f.get();
+        if (added.load() == 0)
+            break;
+    }
+    char buf[160];
+    snprintf(buf, sizeof(buf), "[Optimal] %s: %zu entries, max depth %d, %.1f s", p.name, p.entries, depth,
+             std::chrono::duration<double>(Clock::now() - t0).count());
+    std::cout << buf << std::endl;
+}
+
+bool mapTables(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size != kFileSize)
+    {
+        close(fd);
+        return false;
+    }
+    void *map = mmap(nullptr, kFileSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+    const uint8_t *base = static_cast<const uint8_t *>(map);
+    PdbHeader header;
+    memcpy(&header, base, sizeof(header));
+    if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.entries[0] != kCornerEntries || header.entries[1] != kEdgeEntries || header.entries[2] != kEdgeEntries)
+    {
+        munmap(map, kFileSize);
+        return false;
+    }
+    // 搜索中的查表是随机访问，不需要预读；映射保留到进程结束
+    madvise(map, kFileSize, MADV_RANDOM);
+    tables.corners = base + kHeaderSize;
+    tables.edgesLow = tables.corners + tableBytes(kCornerEntries);
+    tables.edgesHigh = tables.edgesLow + tableBytes(kEdgeEntries);
+    return true;
+}
+
+void mkdirs(const std::string &dir)
+{
+    for (size_t i = 1; i <= dir.size(); ++i)
+        if (i == dir.size() || dir[i] == '/')
+            mkdir(dir.substr(0, i).c_str(), 0755);
+}
+
+// 先写临时文件再 rename，其它进程只会看到完整的表文件
+bool store(const std::string &path, const std::vector<uint8_t> &data)
+{
+    size_t slash = path.rfind('/');
+    if (slash != std::string::npos)
+        mkdirs(path.substr(0, slash));
+    std::string tmp = path + ".tmp." + std::to_string(getpid());
+    FILE *f = fopen(tmp.c_str(), "wb");
+    bool ok = f && fwrite(data.data(), 1, data.size(), f) == data.size();
+    if (f)
+        ok = fclose(f) == 0 && ok;
+    if (ok && rename(tmp.c_str(), path.c_str()) == 0)
+        return true;
+    unlink(tmp.c_str());
+    std::cout << "[Optimal] failed to write " << path << std::endl;
+    return false;
+}
+
+void build(const std::string &path)
+{
+    std::cout << "[Optimal] building pattern databases (one-time, ~87 MB)" << std::endl;
+    heapTables.assign(kFileSize, 0);
+    PdbHeader header = {};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.entries[0] = kCornerEntries;
+    header.entries[1] = kEdgeEntries;
+    header.entries[2] = kEdgeEntries;
+    memcpy(heapTables.data(), &header, sizeof(header));
+
+    uint8_t *table = heapTables.data() + kHeaderSize;
+    ThreadPool pool;
+    for (const Pattern &p : kPatterns)
+    {
+        buildPattern(p, table, pool);
+        table += tableBytes(p.entries);
+    }
+    // 写盘成功就改用映射（页缓存可与其它进程共享），释放堆上的副本
+    if (store(path, heapTables) && mapTables(path))
+    {
+        std::vector<uint8_t>().swap(heapTables);
+        return;
+    }
+    tables.corners = heapTables.data() + kHeaderSize;
+    tables.edgesLow = tables.corners + tableBytes(kCornerEntries);
+    tables.edgesHigh = tables.edgesLow + tableBytes(kEdgeEntries);
+}
+
+// 三张表中是否有一张的下界超过 limit；先查角块表，多数节点在这里就被剪掉
+inline int heuristic(const CubieState &s, int limit)
+{
+    int h = nibble(tables.corners, cornerIndex(s));
+    if (h > limit)
+        return h;
+    h = std::max(h, nibble(tables.edgesLow, edgeIndex(s, 0)));
+    if (h > limit)
+        return h;
+    return std::max(h, nibble(tables.edgesHigh, edgeIndex(s, 6)));
+}
+
+// 同一面不连续转；对面的两个转动可交换，只保留 U 在 D 前（R 在 L 前、F 在 B 前）的顺序
+inline bool redundant(int face, int last)
+{
+    return last >= 0 && (face == last || (face % 3 == last % 3 && face < last));
+}
+
+struct Prefix {
+    CubieState state;
+    MoveId moves[kSplitDepth];
+    int length;
+};
+
+// 一次迭代（固定的 bound）的共享状态
+struct Search {
+    int bound;
+    bool limited;
+    Clock::time_point deadline;
+    const std::atomic<bool> *cancel = nullptr;  // 调用方的取消标志，与超时一起按节点数抽查
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> nodes{0};
+    std::mutex mutex;
+    bool found = false;
+    std::vector<MoveId> solution;
+};
+
+class Worker {
+public:
+    explicit Worker(Search &search) : search(search) {}
+    ~Worker() { search.nodes.fetch_add(nodes, std::memory_order_relaxed); }
+
+    bool run(const CubieState &s, const MoveId *prefix, int length)
+    {
+        std::copy(prefix, prefix + length, path);
+        int last = length > 0 ? moveFace(prefix[length - 1]) : -1;
+        if (!dfs(s, length, last))
+            return false;
+        std::lock_guard<std::mutex> lock(search.mutex);
+        if (!search.found)
+        {
+            search.found = true;
+            search.solution.assign(path, path + search.bound);
+        }
+        search.stop.store(true);
+        return true;
+    }
+
+private:
+    bool dfs(const CubieState &s, int g, int last)
+    {
+        if ((++nodes & 0x3FFF) == 0 && ((search.limited && Clock::now() > search.deadline) ||
+                                         (search.cancel && search.cancel->load(std::memory_order_relaxed))))
+            search.stop.store(true, std::memory_order_relaxed);
+        if (search.stop.load(std::memory_order_relaxed))
+            return false;
+        int left = search.bound - g;
+        int h = heuristic(s, left);
+        if (h > left)
+            return false;
+        // 三张表都为 0 即复原；更短的解在之前的迭代里已经排除，所以 g == bound
+        if (h == 0)
+            return true;
+        for (int m = 0; m < MoveFaceCount; ++m)
+        {
+            int face = moveFace((MoveId)m);
+            if (redundant(face, last))
+                continue;
+            CubieState n = s;
+            applyMove(n, (MoveId)m);
+            path[g] = (MoveId)m;
+            if (dfs(n, g + 1, face))
+                return true;
+        }
+        return false;
+    }
+
+    Search &search;
+    MoveId path[kMaxDepth];
+    uint64_t nodes = 0;
+};
+
+void expandPrefixes(const CubieState &s, MoveId *moves, int length, std::vector<Prefix> &out)
+{
+    if (length == kSplitDepth)
+    {
+        Prefix p;
+        p.state = s;
+        std::copy(moves, moves + length, p.moves);
+        p.length = length;
+        out.push_back(p);
+        return;
+    }
+    int last = length > 0 ? moveFace(moves[length - 1]) : -1;
+    for (int m = 0; m < MoveFaceCount; ++m)
+    {
+        if (redundant(moveFace((MoveId)m), last))
+            continue;
+        CubieState n = s;
+        applyMove(n, (MoveId)m);
+        moves[length] = (MoveId)m;
+        expandPrefixes(n, moves, length + 1, out);
+    }
+}
+
+} // namespace
+
+std::string OptimalSolver::cachePath()
+{
+    if (const char *p = getenv("RUBIK_PDB_CACHE"))
+        return p;
+    return TableCache::cacheDir() + "/korf-v" + std::to_string(kVersion) + ".pdb";
+}
+
+void OptimalSolver::ensureReady()
+{
+    std::call_once(once, [] {
+        std::string path = cachePath();
+        if (mapTables(path))
+            std::cout << "[Optimal] loaded " << path << std::endl;
+        else
+            build(path);
+        ready.store(true, std::memory_order_release);
+    });
+}
+
+bool OptimalSolver::isReady()
+{
+    return ready.load(std::memory_order_acquire);
+}
+
+int OptimalSolver::lowerBound(const CubieState &state)
+{
+    ensureReady();
+    return heuristic(state, kMaxDepth);
+}
+
+OptimalResult OptimalSolver::solve(const CubieState &state, double budgetSeconds, size_t threads,
+                                   const std::atomic<bool> *cancel)
+{
+    ensureReady();
+    Clock::time_point t0 = Clock::now();
+    OptimalResult result = {false, {}, -1, 0, 0.0};
+
+    // 中心块不在原位时先整体转回，搜到的解再共轭回原来的朝向
+    const std::vector<MoveId> *rotation = centerRotation(state);
+    if (!rotation)
+        return result;
+    CubieState start = state;
+    applySequence(start, rotation->data(), rotation->size());
+
+    // 下界本身就说明更短的解不存在
+    int lower = heuristic(start, kMaxDepth);
+    result.depth = lower - 1;
+    std::vector<Prefix> prefixes;
+    std::unique_ptr<ThreadPool> pool;
+    for (int bound = lower; bound <= kMaxDepth; ++bound)
+    {
+        if (cancel && cancel->load())
+            break;
+        Search search;
+        search.bound = bound;
+        search.limited = budgetSeconds > 0;
+        search.deadline = t0 + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(budgetSeconds));
+        search.cancel = cancel;
+        if (bound < kSplitDepth)
+        {
+            // 浅层直接在调用线程里搜
+            Worker(search).run(start, nullptr, 0);
+        }
+        else
+        {
+            if (prefixes.empty())
+            {
+                MoveId moves[kSplitDepth];
+                expandPrefixes(start, moves, 0, prefixes);
+                pool.reset(new ThreadPool(threads));
+            }
+            std::atomic<size_t> next{0};
+            std::vector<std::future<void>> tasks;
+            for (size_t t = 0; t < pool->size(); ++t)
+                tasks.push_back(pool->submit([&] {
+                    Worker worker(search);
+                    for (size_t i = next.fetch_add(1); i < prefixes.size() && !search.stop.load(); i = next.fetch_add(1))
+                        worker.run(prefixes[i].state, prefixes[i].moves, prefixes[i].length);
+                }));
+            for (auto &f : tasks)
+                f.get();
+        }
+        result.nodes += search.nodes.load();
+        if (search.found)
+        {
+            result.solved = true;
+            result.moves = search.solution;
+            result.depth = bound;
+            break;
+        }
+        // 时间用完：这一层没有搜完
+        if (search.stop.load())
+            break;
+        result.depth = bound;
+    }
+    if (result.solved)
+        conjugateMoves(result.moves, *rotation);
+    result.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    return result;
+}
@@ -0,0 +1,120 @@
+#include "profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct State {
+    FrameSample ring[Profiler::kCapacity];
+    std::atomic<uint64_t> head{0};                // 已写入的帧数
+    std::atomic<int64_t> pendingNs[ZoneCount] = {};  // 当前帧各分区的累计耗时
+    Clock::time_point frameStart;
+    Clock::time_point lastStart;
+    bool started = false;
+};
+
+State &state()
+{
+    static State s;
+    return s;
+}
+
+float toUs(Clock::duration d)
+{
+    return std::chrono::duration<float, std::micro>(d).count();
+}
+
+} // namespace
+
+void Profiler::beginFrame()
+{
+    State &s = state();
+    Clock::time_point now = Clock::now();
+    s.lastStart = s.started ? s.frameStart : now;
+    s.frameStart = now;
+    s.started = true;
+}
+
+void Profiler::endFrame(bool drawn)
+{
+    State &s = state();
+    if (!s.started)
+        return;
+    uint64_t h = s.head.load(std::memory_order_relaxed);
+    FrameSample &f = s.ring[h % kCapacity];
+    f.frame = h;
+    f.intervalUs = toUs(s.frameStart - s.lastStart);
+    f.cpuUs = toUs(Clock::now() - s.frameStart);
+    for (int z = 0; z < ZoneCount; ++z)
+        f.zoneUs[z] = (float)s.pendingNs[z].exchange(0, std::memory_order_relaxed) / 1000.0f;
+    f.drawn = drawn;
+    s.head.store(h + 1, std::memory_order_release);
+}
+
+void Profiler::add(ProfileZone zone, Clock::duration elapsed)
+{
+    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    state().pendingNs[zone].fetch_add(ns, std::memory_order_relaxed);
+}
+
+size_t Profiler::count()
+{
+    uint64_t h = state().head.load(std::memory_order_acquire);
+    return h < kCapacity ? (size_t)h : kCapacity;
+}
+
+FrameSample Profiler::sample(size_t i)
+{
+    uint64_t h = state().head.load(std::memory_order_acquire);
+    uint64_t first = h - count();
+    return state().ring[(first + i) % kCapacity];
+}
+
+float Profiler::intervalPercentile(size_t n, float p)
+{
+    size_t total = count();
+    n = std::min(n, total);
+    std::vector<float> v;
+    v.reserve(n);
+    for (size_t i = total - n; i < total; ++i)
+    {
+        FrameSample f = sample(i);
+        if (f.drawn)
+            v.push_back(f.intervalUs);
+    }
+    if (v.empty())
+        return 0.0f;
+    size_t k = (size_t)(p * (float)(v.size() - 1) + 0.5f);
+    std::nth_element(v.begin(), v.begin() + (long)k, v.end());
+    return v[k];
+}
+
+bool Profiler::dumpCsv(const std::string &path)
+{
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f)
+        return false;
+    fprintf(f, "frame,drawn,interval_us,cpu_us");
+    for (int z = 0; z < ZoneCount; ++z)
+        fprintf(f, ",%s_us", zoneName((ProfileZone)z));
+    fprintf(f, "\n");
+    size_t n = count();
+    for (size_t i = 0; i < n; ++i)
+    {
+        FrameSample s = sample(i);
+        fprintf(f, "%llu,%d,%.1f,%.1f", (unsigned long long)s.frame, s.drawn ? 1 : 0, s.intervalUs, s.cpuUs);
+        for (int z = 0; z < ZoneCount; ++z)
+            fprintf(f, ",%.1f", s.zoneUs[z]);
+        fprintf(f, "\n");
+    }
+    return fclose(f) == 0;
+}
+
+const char *Profiler::zoneName(ProfileZone zone)
+{
+    static const char *const kNames[ZoneCount] = {"update", "draw3d", "highlight", "ui", "solve", "rotate_layer"};
+    return zone < ZoneCount ? kNames[zone] : "?";
+}
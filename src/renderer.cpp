@@ -2,6 +2,48 @@
 #include <rlgl.h>
 #include <raymath.h> // 如果需要使用Raylib数学函数（也可使用cmath）
 #include <raylib.h>
+#include "profiler.h"
+
+namespace {
+
+// 实例化着色器：每个实例一个模型矩阵，颜色取材质的漫反射色（同一批实例同色）
+const char *kInstancedVS = R"(#version 330
+in vec3 vertexPosition;
+in mat4 instanceTransform;
+uniform mat4 mvp;
+uniform vec4 colDiffuse;
+out vec4 fragColor;
+void main()
+{
+    fragColor = colDiffuse;
+    gl_Position = mvp * instanceTransform * vec4(vertexPosition, 1.0);
+}
+)";
+
+const char *kInstancedFS = R"(#version 330
+in vec4 fragColor;
+out vec4 finalColor;
+void main()
+{
+    finalColor = fragColor;
+}
+)";
+
+// 贴纸网格（法线 +Z）在小块局部坐标下贴到各个面上的变换，按 Face 枚举顺序
+const float kStickerOffset = 0.475f + 0.01f; // 小块半边长 + 贴纸偏移
+const Matrix kStickerLocal[6] = {
+    MatrixMultiply(MatrixRotateY(-PI / 2), MatrixTranslate(-kStickerOffset, 0, 0)), // LEFT
+    MatrixMultiply(MatrixRotateY(PI / 2), MatrixTranslate(kStickerOffset, 0, 0)),   // RIGHT
+    MatrixMultiply(MatrixRotateX(PI / 2), MatrixTranslate(0, -kStickerOffset, 0)),  // DOWN
+    MatrixMultiply(MatrixRotateX(-PI / 2), MatrixTranslate(0, kStickerOffset, 0)),  // UP
+    MatrixMultiply(MatrixRotateY(PI), MatrixTranslate(0, 0, -kStickerOffset)),      // BACK
+    MatrixTranslate(0, 0, kStickerOffset),                                           // FRONT
+};
+
+// 各面的外法线，按 Face 枚举顺序（Face = 轴 * 2 + 正负侧）
+const Vector3 kFaceNormal[6] = {{-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}};
+
+} // namespace
 
 Renderer::Renderer(int screenWidth, int screenHeight)
     : screenWidth(screenWidth), screenHeight(screenHeight)
@@ -15,14 +57,213 @@ Renderer::Renderer(int screenWidth, int screenHeight)
     camera.up = {0.0f, 1.0f, 0.0f};       // 世界上方向 (Y轴)
     camera.fovy = 45.0f;
     background = LoadImage("/Users/bo_yu/Documents/bupt/l_linux/linux-3d-cube/new-cube/include/background.jpg");
-    SetTargetFPS(80); // 设置帧率
+
+    // 小块本体和圆角贴纸只生成一次，之后每帧按实例变换绘制
+    bodyMesh = GenMeshCube(0.95f, 0.95f, 0.95f);
+    stickerMesh = genStickerMesh();
+    Shader shader = LoadShaderFromMemory(kInstancedVS, kInstancedFS);
+    shader.locs[SHADER_LOC_MATRIX_MVP] = GetShaderLocation(shader, "mvp");
+    shader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(shader, "instanceTransform");
+    material = LoadMaterialDefault();
+    material.shader = shader;
+    cacheValid = false;
 }
 
 Renderer::~Renderer()
 {
+    UnloadMesh(bodyMesh);
+    UnloadMesh(stickerMesh);
+    UnloadMaterial(material); // 同时卸载实例化着色器
     CloseWindow();
 }
 
+// 圆角贴纸：边长 0.89、圆角半径 0.07、厚 0.02 的圆角方板，法线朝 +Z，中心在原点
+// （与原先两块十字薄板加四个圆柱拼出的外形一致）
+Mesh Renderer::genStickerMesh()
+{
+    const float half = 0.445f, radius = 0.07f, inner = half - radius, depth = 0.01f;
+    const int segments = 4;                  // 每个圆角的分段数
+    const int ring = 4 * (segments + 1);     // 外轮廓点数
+    Vector2 outline[ring];
+    const float cx[4] = {inner, -inner, -inner, inner};
+    const float cy[4] = {inner, inner, -inner, -inner};
+    for (int c = 0; c < 4; ++c)
+        for (int k = 0; k <= segments; ++k)
+        {
+            float t = (c + (float)k / segments) * (PI / 2.0f);
+            outline[c * (segments + 1) + k] = {cx[c] + radius * cosf(t), cy[c] + radius * sinf(t)};
+        }
+
+    Mesh mesh = {};
+    mesh.triangleCount = ring * 4;           // 上下两个扇面 + 侧面每段两个三角形
+    mesh.vertexCount = mesh.triangleCount * 3;
+    mesh.vertices = (float *)MemAlloc(mesh.vertexCount * 3 * sizeof(float));
+    mesh.normals = (float *)MemAlloc(mesh.vertexCount * 3 * sizeof(float));
+    int v = 0;
+    auto put = [&](float x, float y, float z, float nx, float ny, float nz) {
+        mesh.vertices[v * 3 + 0] = x;
+        mesh.vertices[v * 3 + 1] = y;
+        mesh.vertices[v * 3 + 2] = z;
+        mesh.normals[v * 3 + 0] = nx;
+        mesh.normals[v * 3 + 1] = ny;
+        mesh.normals[v * 3 + 2] = nz;
+        ++v;
+    };
+    for (int i = 0; i < ring; ++i)
+    {
+        Vector2 a = outline[i], b = outline[(i + 1) % ring];
+        // 正面（逆时针朝 +Z）与背面
+        put(0, 0, depth, 0, 0, 1);
+        put(a.x, a.y, depth, 0, 0, 1);
+        put(b.x, b.y, depth, 0, 0, 1);
+        put(0, 0, -depth, 0, 0, -1);
+        put(b.x, b.y, -depth, 0, 0, -1);
+        put(a.x, a.y, -depth, 0, 0, -1);
+        // 侧面（外法线）
+        float nx = (b.y - a.y), ny = (a.x - b.x), len = sqrtf(nx * nx + ny * ny);
+        nx /= len;
+        ny /= len;
+        put(a.x, a.y, -depth, nx, ny, 0);
+        put(b.x, b.y, -depth, nx, ny, 0);
+        put(b.x, b.y, depth, nx, ny, 0);
+        put(a.x, a.y, -depth, nx, ny, 0);
+        put(b.x, b.y, depth, nx, ny, 0);
+        put(a.x, a.y, depth, nx, ny, 0);
+    }
+    UploadMesh(&mesh, false);
+    return mesh;
+}
+
+// 重新生成实例变换：不在转动层的小块缓存到 staticInstances，只在魔方状态、转动层或可见面改变时重建；
+// 正在转动的小块每帧写入 movingInstances。只提交朝向摄像机的贴纸和至少有一个可见面的小块本体
+// （任一视角最多看到三个外表面，3 阶约 27 张贴纸、19 个本体，约为全部几何的一半）
+void Renderer::updateInstances(const Cube &cube, const Controller &controller)
+{
+    bool animating = controller.isRotating();
+    bool turning = animating && controller.getIsTurning();
+    Axis rotAxis = controller.getRotationAxis();
+    int rotLayer = controller.getRotationLayer();
+    int n = controller.getLayerCount();
+    float half = (float)(n - 1) * 0.5f;  // 层号 -> 以魔方中心为原点的坐标
+    // 未在动画时用 -1 表示没有转动层；翻转（T）时整个魔方都在转动
+    int movingKey = !animating ? -1 : (turning ? 3 * n : rotAxis * n + rotLayer);
+
+    // 静止小块的面与坐标轴对齐，面朝向摄像机 <=> 摄像机在该面所在平面之外。
+    // 用到的平面只有魔方的 6 个外表面和转动层两侧的两个切面，它们的可见性合起来作为缓存键的一部分，
+    // 摄像机环绕时只有跨过某个平面才重建静止部分
+    const float eye[3] = {camera.position.x, camera.position.y, camera.position.z};
+    auto beyond = [&](int axis, int side, float plane) { return side ? eye[axis] > plane : eye[axis] < plane; };
+    int viewKey = 0;
+    for (int f = 0; f < 6; ++f)
+        viewKey |= beyond(f >> 1, f & 1, (f & 1) ? half + 0.5f : -half - 0.5f) << f;
+    if (animating && !turning)
+    {
+        float layerCoord = (float)rotLayer - half;
+        viewKey |= beyond(rotAxis, 1, layerCoord - 0.5f) << 6 | beyond(rotAxis, 0, layerCoord + 0.5f) << 7;
+    }
+
+    bool rebuildStatic = !cacheValid || cube.state() != cachedState || movingKey != cachedMovingKey ||
+                         viewKey != cachedViewKey;
+    if (rebuildStatic)
+    {
+        for (auto &group : staticInstances)
+            group.clear();
+        cachedState = cube.state();
+        cachedMovingKey = movingKey;
+        cachedViewKey = viewKey;
+        cacheValid = true;
+    }
+    for (auto &group : movingInstances)
+        group.clear();
+
+    // 当前转动层的旋转（角度为度数，正负沿用 controller 的约定）；翻转时绕 X 轴转两倍角度
+    Matrix layerRotation = MatrixIdentity();
+    if (animating)
+    {
+        float angle = controller.getRotationAngle() * DEG2RAD;
+        if (turning)
+            layerRotation = MatrixRotateX(2.0f * angle);
+        else if (rotAxis == AxisX)
+            layerRotation = MatrixRotateX(angle);
+        else if (rotAxis == AxisY)
+            layerRotation = MatrixRotateY(angle);
+        else
+            layerRotation = MatrixRotateZ(angle);
+    }
+
+    for (int x = 0; x < n; ++x)
+        for (int y = 0; y < n; ++y)
+            for (int z = 0; z < n; ++z)
+            {
+                int coord[3] = {x, y, z};
+                bool moving = animating && (turning || coord[rotAxis] == rotLayer);
+                if (!moving && !rebuildStatic)
+                    continue;
+                // 露在外面的面：魔方表面上的面；层转动时再加上转动层两侧的切面（转动层自己的两面、
+                // 相邻静止层朝向它的一面），其余的面贴着同一刚体内的相邻小块，看不到
+                int exposed = 0;
+                for (int a = 0; a < 3; ++a)
+                    exposed |= (coord[a] == 0) << (2 * a) | (coord[a] == n - 1) << (2 * a + 1);
+                if (animating && !turning)
+                {
+                    int d = coord[rotAxis] - rotLayer;
+                    if (d >= -1 && d <= 1)
+                        exposed |= (d <= 0) << (2 * rotAxis + 1) | (d >= 0) << (2 * rotAxis);
+                }
+                // 露在外面且朝向摄像机的面；一个面都没有的小块（中心核、被挡住的块）整块跳过
+                float pos[3] = {(float)x - half, (float)y - half, (float)z - half};
+                int visible = 0;
+                for (int f = 0; f < 6; ++f)
+                {
+                    if (!(exposed >> f & 1))
+                        continue;
+                    if (!moving)
+                    {
+                        int side = f & 1;
+                        visible |= beyond(f >> 1, side, pos[f >> 1] + (side ? 0.5f : -0.5f)) << f;
+                        continue;
+                    }
+                    // 转动中的小块：法线和面中心随层旋转，按 (摄像机 - 面中心) · 法线 > 0 判断
+                    Vector3 normal = Vector3Transform(kFaceNormal[f], layerRotation);
+                    Vector3 center = Vector3Transform({pos[0] + 0.5f * kFaceNormal[f].x, pos[1] + 0.5f * kFaceNormal[f].y,
+                                                       pos[2] + 0.5f * kFaceNormal[f].z},
+                                                      layerRotation);
+                    visible |= (Vector3DotProduct(Vector3Subtract(camera.position, center), normal) > 0.0f) << f;
+                }
+                if (visible == 0)
+                    continue;
+
+                // 先平移到世界位置（魔方中心为原点），转动层再绕轴整体旋转
+                Matrix piece = MatrixTranslate(pos[0], pos[1], pos[2]);
+                if (moving)
+                    piece = MatrixMultiply(piece, layerRotation);
+                auto &groups = moving ? movingInstances : staticInstances;
+                groups[kBodyGroup].push_back(piece);
+                for (int f = 0; f < 6; ++f)
+                {
+                    if (!(visible >> f & 1))
+                        continue;
+                    int home = cube.stickerHome(x, y, z, (Face)f);
+                    if (home >= 0)
+                        groups[home].push_back(MatrixMultiply(kStickerLocal[f], piece));
+                }
+            }
+}
+
+// 每种颜色最多两次实例化绘制（静止 + 转动中），代替逐块逐贴纸的立即模式调用
+void Renderer::drawInstances()
+{
+    for (int g = 0; g < kGroupCount; ++g)
+    {
+        const Mesh &mesh = g == kBodyGroup ? bodyMesh : stickerMesh;
+        material.maps[MATERIAL_MAP_DIFFUSE].color = g == kBodyGroup ? Color{30, 30, 30, 255} : Cube::homeColor((Face)g);
+        if (!staticInstances[g].empty())
+            DrawMeshInstanced(mesh, material, staticInstances[g].data(), (int)staticInstances[g].size());
+        if (!movingInstances[g].empty())
+            DrawMeshInstanced(mesh, material, movingInstances[g].data(), (int)movingInstances[g].size());
+    }
+}
+
 
 void Renderer::drawFrame(const Cube &cube, const Controller &controller)
 {
@@ -45,268 +286,23 @@ void Renderer::drawFrame(const Cube &cube, const Controller &controller)
 
     // ImageClearBackground(&background, DARKGRAY);
 
+    auto passStart = std::chrono::steady_clock::now();
     BeginMode3D(camera);
 
     bool animating = controller.isRotating();
     Axis rotAxis = controller.getRotationAxis();
     int rotLayer = controller.getRotationLayer();
     float angle = controller.getRotationAngle(); // 保持原值（正/负角度）
+    float half = (float)(controller.getLayerCount() - 1) * 0.5f;  // 层号 -> 坐标
+    float extent = half + 0.5f;                                      // 魔方范围为 [-extent, extent]
 
     // 注意：我们不再做方向判断，不修改 angle，不做 angle = -angle
 
-    // 遍历所有小立方块
-    for (int x = 0; x < 3; ++x)
-    {
-        for (int y = 0; y < 3; ++y)
-        {
-            for (int z = 0; z < 3; ++z)
-            {
-                CubePiece *piece = cube.getPiece(x, y, z);
-                // 计算小块的世界坐标位置 (将魔方中心设为(0,0,0)，每块间隔1单位)
-                // 我们将魔方3x3范围设为[-1,1]，因此坐标换算：world = (x-1, y-1, z-1)
-                float worldX = (float)(x - 1);
-                float worldY = (float)(y - 1);
-                float worldZ = (float)(z - 1);
-
-                // 判断该小块是否在当前旋转的层内
-                bool inRotatingLayer = false;
-                if (animating)
-                {
-                    if ((rotAxis == AxisX && x == rotLayer) ||
-                        (rotAxis == AxisY && y == rotLayer) ||
-                        (rotAxis == AxisZ && z == rotLayer))
-                    {
-                        inRotatingLayer = true;
-                    }
-                    if (controller.getIsTurning()){
-                        inRotatingLayer = true;
-                    }
-                }
-
-                if (animating && inRotatingLayer)
-                {
-                    // 对处于旋转层的小块应用旋转变换
-                    rlPushMatrix();
-                    // 定义该层旋转轴经过的中心点（轴线穿过魔方中心或边中心）
-                    Vector3 pivot = {0.0f, 0.0f, 0.0f};
-                    if (controller.getIsTurning()){
-                        pivot = {worldX, 0.0f, 0.0f}; // X层的轴线通过该层中心 (x定值, y=z=0)
-                        rlTranslatef(pivot.x, pivot.y, pivot.z);
-                        SetTargetFPS(40);
-                        rlRotatef(angle, 1.0f, 0.0f, 0.0f);
-                        rlTranslatef(-pivot.x, -pivot.y, -pivot.z);
-                    }
-                    if (rotAxis == AxisX || controller.getIsTurning())
-                    {
-                        pivot = {worldX, 0.0f, 0.0f}; // X层的轴线通过该层中心 (x定值, y=z=0)
-                        rlTranslatef(pivot.x, pivot.y, pivot.z);
-                        rlRotatef(angle, 1.0f, 0.0f, 0.0f);
-                        rlTranslatef(-pivot.x, -pivot.y, -pivot.z);
-                    }
-                    else if (rotAxis == AxisY)
-                    {
-                        pivot = {0.0f, worldY, 0.0f}; // Y层轴线 (y定值)
-                        rlTranslatef(pivot.x, pivot.y, pivot.z);
-                        rlRotatef(angle, 0.0f, 1.0f, 0.0f);
-                        rlTranslatef(-pivot.x, -pivot.y, -pivot.z);
-                    }
-                    else if (rotAxis == AxisZ)
-                    {
-                        pivot = {0.0f, 0.0f, worldZ}; // Z层轴线 (z定值)
-                        rlTranslatef(pivot.x, pivot.y, pivot.z);
-                        rlRotatef(angle, 0.0f, 0.0f, 1.0f);
-                        rlTranslatef(-pivot.x, -pivot.y, -pivot.z);
-                    }
-                    // 旋转后再平移小块到其世界位置
-                    rlTranslatef(worldX, worldY, worldZ);
-
-
-                    // 绘制该小块（黑色底立方体 + 6个有色面）
-                    DrawCubeV(Vector3{0, 0, 0}, (Vector3){0.95f, 0.95f, 0.95f}, {30, 30, 30, 255});
-                    DrawCubeWiresV(Vector3{0, 0, 0}, (Vector3){0.95f, 0.95f, 0.95f}, BLACK);
-                    // 绘制每个有颜色的面贴纸（用薄板表示）
-                    float half = 0.475f; // 小块半边长
-                    float pad = 0.01f;  // 贴纸板厚度或偏移
-                    if (piece->faceColor[LEFT].a != 0)
-                    {
-                        Color col = piece->faceColor[LEFT];
-                        DrawCube(Vector3{-half - pad, 0, 0}, 0.02f, 0.89f, 0.75f, col);
-                        DrawCube(Vector3{-half - pad, 0, 0}, 0.02f, 0.75f, 0.89f, col);
-                        for(int i = -1; i < 2; i += 2){
-                            for(int j = -1; j < 2; j += 2)
-                                DrawCylinderEx(
-                                    Vector3{-half - pad - 0.01f, 0.375f * i, 0.375f * j},
-                                    Vector3{-half - pad + 0.01f, 0.375f * i, 0.375f * j},
-                                    0.07f, 0.07f, 16, col);
-                        }
-                    }
-                    if (piece->faceColor[RIGHT].a != 0)
-                    {
-                        Color col = piece->faceColor[RIGHT];
-                        DrawCube(Vector3{half + pad, 0, 0}, 0.02f, 0.89f, 0.75f, col);
-                        DrawCube(Vector3{half + pad, 0, 0}, 0.02f, 0.75f, 0.89f, col);
-                        for(int i = -1; i < 2; i += 2){
-                            for(int j = -1; j < 2; j += 2)
-                                DrawCylinderEx(
-                                    Vector3{half + pad - 0.01f, 0.375f * i, 0.375f * j},
-                                    Vector3{half + pad + 0.01f, 0.375f * i, 0.375f * j},
-                                    0.07f, 0.07f, 16, col);
-                        }
-                    }
-                    if (piece->faceColor[DOWN].a != 0)
-                    {
-                        // DrawCube(Vector3{0, -half - pad, 0}, 0.75f, 0.02f, 0.75f, piece->faceColor[DOWN]);
-                        Color col = piece->faceColor[DOWN];
-                        DrawCube(Vector3{0, -half - pad, 0}, 0.89f, 0.02f, 0.75f, col);
-                        DrawCube(Vector3{0, -half - pad, 0}, 0.75f, 0.02f, 0.89f, col);
-                        for(int i = -1; i < 2; i += 2){
-                            for(int j = -1; j < 2; j += 2)
-                                DrawCylinderEx(
-                                    Vector3{0.375f * i, -half - pad - 0.01f, 0.375f * j},
-                                    Vector3{0.375f * i, -half - pad + 0.01f, 0.375f * j},
-                                    0.07f, 0.07f, 16, col);
-                        }
-                    }
-                    if (piece->faceColor[UP].a != 0)
-                    {
-                        // DrawCube(Vector3{0, half + pad, 0}, 0.75f, 0.02f, 0.75f, piece->faceColor[UP]);
-                        Color col = piece->faceColor[UP];
-                        DrawCube(Vector3{0, half + pad, 0}, 0.89f, 0.02f, 0.75f, col);
-                        DrawCube(Vector3{0, half + pad, 0}, 0.75f, 0.02f, 0.89f, col);
-                        for(int i = -1; i < 2; i += 2){
-                            for(int j = -1; j < 2; j += 2)
-                                DrawCylinderEx(
-                                    Vector3{0.375f * i, half + pad - 0.01f, 0.375f * j},
-                                    Vector3{0.375f * i, half + pad + 0.01f, 0.375f * j},
-                                    0.07f, 0.07f, 16, col);
-                        }
-                    }
-                    if (piece->faceColor[BACK].a != 0)
-                    {
-                        // DrawCube(Vector3{0, 0, -half - pad}, 0.75f, 0.75f, 0.02f, piece->faceColor[BACK]);
-                        Color col = piece->faceColor[BACK];
-                        DrawCube(Vector3{0, 0, -half - pad}, 0.89f, 0.75f, 0.02f, col);
-                        DrawCube(Vector3{0, 0, -half - pad}, 0.75f, 0.89f, 0.02f, col);
-                        for(int i = -1; i < 2; i += 2){ 
-                            for(int j = -1; j < 2; j += 2)
-                                DrawCylinderEx(
-                                    Vector3{0.375f * i, 0.375f * j, -half - pad - 0.01f},
-                                    Vector3{0.375f * i, 0.375f * j, -half - pad + 0.01f},
-                                    0.07f, 0.07f, 16, col);
-                        }
-                    }
-                    if (piece->faceColor[FRONT].a != 0)
-                    {
-                        // DrawCube(Vector3{0, 0, half + pad}, 0.75f, 0.75f, 0.02f, piece->faceColor[FRONT]);
-                        Color col = piece->faceColor[FRONT];
-                        DrawCube(Vector3{0, 0, half + pad}, 0.89f, 0.75f, 0.02f, col);
-                        DrawCube(Vector3{0, 0, half + pad}, 0.75f, 0.89f, 0.02f, col);
-                        for(int i = -1; i < 2; i += 2){
-                            for(int j = -1; j < 2; j += 2)
-                                DrawCylinderEx(
-                                    Vector3{0.375f * i, 0.375f * j, half + pad - 0.01f},
-                                    Vector3{0.375f * i, 0.375f * j, half + pad + 0.01f},
-                                    0.07f, 0.07f, 16, col);  
-                        }
-                    }
-                    rlPopMatrix();
-                }
-                else
-                {
-                    // 普通绘制（无动画或不在旋转层的小块）
-                    rlPushMatrix();
-                    rlTranslatef(worldX, worldY, worldZ);
-                    DrawCubeV(Vector3{0, 0, 0}, (Vector3){0.95f, 0.95f, 0.95f}, {30, 30, 30, 255});
-                    DrawCubeWiresV(Vector3{0, 0, 0}, (Vector3){0.95f, 0.95f, 0.95f}, BLACK);
-                    // DrawCube(Vector3{0, 0, 0}, 0.9f, 0.9f, 0.9f, BLACK);
-                    float half = 0.475f, pad = 0.01f;
-                    if (piece->faceColor[LEFT].a != 0)
-                    {
-                        Color col = piece->faceColor[LEFT];
-                        DrawCube(Vector3{-half - pad, 0, 0}, 0.02f, 0.89f, 0.75f, col);
-                        DrawCube(Vector3{-half - pad, 0, 0}, 0.02f, 0.75f, 0.89f, col);
-                        for(int i = -1; i < 2; i += 2){
-                            for(int j = -1; j < 2; j += 2)
-                                DrawCylinderEx(
-                                    Vector3{-half - pad - 0.01f, 0.375f * i, 0.375f * j},
-                                    Vector3{-half - pad + 0.01f, 0.375f * i, 0.375f * j},
-                                    0.07f, 0.07f, 16, col);
-                        }
-                    }
-                    if (piece->faceColor[RIGHT].a != 0)
-                    {
-                        Color col = piece->faceColor[RIGHT];
-                        DrawCube(Vector3{half + pad, 0, 0}, 0.02f, 0.89f, 0.75f, col);
-                        DrawCube(Vector3{half + pad, 0, 0}, 0.02f, 0.75f, 0.89f, col);
-                        for(int i = -1; i < 2; i += 2){
-                            for(int j = -1; j < 2; j += 2)
-                                DrawCylinderEx(
-                                    Vector3{half + pad - 0.01f, 0.375f * i, 0.375f * j},
-                                    Vector3{half + pad + 0.01f, 0.375f * i, 0.375f * j},
-                                    0.07f, 0.07f, 16, col);
-                        }
-                    }
-                    if (piece->faceColor[DOWN].a != 0)
-                    {
-                        // DrawCube(Vector3{0, -half - pad, 0}, 0.75f, 0.02f, 0.75f, piece->faceColor[DOWN]);
-                        Color col = piece->faceColor[DOWN];
-                        DrawCube(Vector3{0, -half - pad, 0}, 0.89f, 0.02f, 0.75f, col);
-                        DrawCube(Vector3{0, -half - pad, 0}, 0.75f, 0.02f, 0.89f, col);
-                        for(int i = -1; i < 2; i += 2){
-                            for(int j = -1; j < 2; j += 2)
-                                DrawCylinderEx(
-                                    Vector3{0.375f * i, -half - pad - 0.01f, 0.375f * j},
-                                    Vector3{0.375f * i, -half - pad + 0.01f, 0.375f * j},
-                                    0.07f, 0.07f, 16, col);
-                        }
-                    }
-                    if (piece->faceColor[UP].a != 0)
-                    {
-                        // DrawCube(Vector3{0, half + pad, 0}, 0.75f, 0.02f, 0.75f, piece->faceColor[UP]);
-                        Color col = piece->faceColor[UP];
-                        DrawCube(Vector3{0, half + pad, 0}, 0.89f, 0.02f, 0.75f, col);
-                        DrawCube(Vector3{0, half + pad, 0}, 0.75f, 0.02f, 0.89f, col);
-                        for(int i = -1; i < 2; i += 2){
-                            for(int j = -1; j < 2; j += 2)
-                                DrawCylinderEx(
-                                    Vector3{0.375f * i, half + pad - 0.01f, 0.375f * j},
-                                    Vector3{0.375f * i, half + pad + 0.01f, 0.375f * j},
-                                    0.07f, 0.07f, 16, col);
-                        }
-                    }
-                    if (piece->faceColor[BACK].a != 0)
-                    {
-                        // DrawCube(Vector3{0, 0, -half - pad}, 0.75f, 0.75f, 0.02f, piece->faceColor[BACK]);
-                        Color col = piece->faceColor[BACK];
-                        DrawCube(Vector3{0, 0, -half - pad}, 0.89f, 0.75f, 0.02f, col);
-                        DrawCube(Vector3{0, 0, -half - pad}, 0.75f, 0.89f, 0.02f, col);
-                        for(int i = -1; i < 2; i += 2){ 
-                            for(int j = -1; j < 2; j += 2)
-                                DrawCylinderEx(
-                                    Vector3{0.375f * i, 0.375f * j, -half - pad - 0.01f},
-                                    Vector3{0.375f * i, 0.375f * j, -half - pad + 0.01f},
-                                    0.07f, 0.07f, 16, col);
-                        }
-                    }
-                    if (piece->faceColor[FRONT].a != 0)
-                    {
-                        // DrawCube(Vector3{0, 0, half + pad}, 0.75f, 0.75f, 0.02f, piece->faceColor[FRONT]);
-                        Color col = piece->faceColor[FRONT];
-                        DrawCube(Vector3{0, 0, half + pad}, 0.89f, 0.75f, 0.02f, col);
-                        DrawCube(Vector3{0, 0, half + pad}, 0.75f, 0.89f, 0.02f, col);
-                        for(int i = -1; i < 2; i += 2){
-                            for(int j = -1; j < 2; j += 2)
-                                DrawCylinderEx(
-                                    Vector3{0.375f * i, 0.375f * j, half + pad - 0.01f},
-                                    Vector3{0.375f * i, 0.375f * j, half + pad + 0.01f},
-                                    0.07f, 0.07f, 16, col);  
-                        }
-                    }
-                    rlPopMatrix();
-                }
-            }
-        }
-    }
+    // 魔方本体：按颜色分组的实例化绘制，静止部分只在魔方状态或转动层变化时重建
+    updateInstances(cube, controller);
+    drawInstances();
+    Profiler::add(ZoneDraw3D, std::chrono::steady_clock::now() - passStart);
+    passStart = std::chrono::steady_clock::now();
 
     /******************************************/ /******************************************/
     // --- 动态绘制选中层的线框和透明罩，使其随旋转动画同步 ---
@@ -319,7 +315,7 @@ void Renderer::drawFrame(const Cube &cube, const Controller &controller)
             rlPushMatrix();
 
             // 找出旋转层中心点
-            float layerCoord = (float)(rotLayer - 1);
+            float layerCoord = (float)rotLayer - half;
             Vector3 pivot = {0};
             if (rotAxis == AxisX)
                 pivot = {layerCoord, 0.0f, 0.0f};
@@ -342,8 +338,8 @@ void Renderer::drawFrame(const Cube &cube, const Controller &controller)
             rlTranslatef(-pivot.x, -pivot.y, -pivot.z);
 
             // 计算层的最小/最大 corner（与前面相同）
-            Vector3 minCorner = {-1.5f, -1.5f, -1.5f};
-            Vector3 maxCorner = {1.5f, 1.5f, 1.5f};
+            Vector3 minCorner = {-extent, -extent, -extent};
+            Vector3 maxCorner = {extent, extent, extent};
             if (rotAxis == AxisX)
             {
                 float x = layerCoord;
@@ -387,26 +383,26 @@ void Renderer::drawFrame(const Cube &cube, const Controller &controller)
             Axis selAxis = controller.getSelectedAxis();
             int selLayer = controller.getSelectedLayer();
 
-            // 计算该层的起点与终点坐标（魔方范围为 [-1,1]）
-            Vector3 minCorner = {-1.5f, -1.5f, -1.5f};
-            Vector3 maxCorner = {1.5f, 1.5f, 1.5f};
+            // 计算该层的起点与终点坐标
+            Vector3 minCorner = {-extent, -extent, -extent};
+            Vector3 maxCorner = {extent, extent, extent};
 
             // 将所选轴方向压缩为该层范围
             if (selAxis == AxisX)
             {
-                float x = (float)(selLayer - 1); // -1, 0, 1
+                float x = (float)selLayer - half; // 3 阶时为 -1, 0, 1
                 minCorner.x = x - 0.5f;
                 maxCorner.x = x + 0.5f;
             }
             else if (selAxis == AxisY)
             {
-                float y = (float)(selLayer - 1);
+                float y = (float)selLayer - half;
                 minCorner.y = y - 0.5f;
                 maxCorner.y = y + 0.5f;
             }
             else if (selAxis == AxisZ)
             {
-                float z = (float)(selLayer - 1);
+                float z = (float)selLayer - half;
                 minCorner.z = z - 0.5f;
                 maxCorner.z = z + 0.5f;
             }
@@ -428,6 +424,8 @@ void Renderer::drawFrame(const Cube &cube, const Controller &controller)
     /******************************************/ /******************************************/
 
     EndMode3D();
+    Profiler::add(ZoneHighlight, std::chrono::steady_clock::now() - passStart);
+    ProfileScope uiScope(ZoneUI);
 
     // 文字UI：显示当前选择轴和层，以及操作提示
     int textX = 15, textY = 15, i = 0;
@@ -444,5 +442,47 @@ void Renderer::drawFrame(const Cube &cube, const Controller &controller)
     DrawText("U: Solve the Rubik Automaticly", textX, textY + 30*(i++), 20, LIGHTGRAY);
     if (controller.getIsScrambling()) DrawText("Scrambling...", textX, textY + 30*(i++), 20, PURPLE);
     else if (controller.getIsSolving()) DrawText("Solving...", textX, textY + 30*(i++), 20, PURPLE);
+    if (controller.getShowProfiler()) drawProfilerOverlay();
+    else DrawText("F1: Frame Timing", textX, textY + 30*(i++), 20, LIGHTGRAY);
     EndDrawing();
+}
+
+// 帧耗时叠加层：最近 240 帧的帧时间曲线（虚线为 80 FPS 预算）、p50/p99 以及上一个绘制帧的各分区耗时
+void Renderer::drawProfilerOverlay()
+{
+    const int w = 360, h = 120, x = screenWidth - w - 15, y = 15;
+    const size_t frames = 240;
+    const float budgetUs = 1e6f / 80.0f;
+    const float scaleUs = budgetUs * 2.0f; // 图表上沿对应 2 倍预算
+
+    DrawRectangle(x, y, w, h, ColorAlpha(BLACK, 0.5f));
+    for (int dx = 0; dx < w; dx += 8)
+        DrawLine(x + dx, y + h / 2, x + dx + 4, y + h / 2, GOLD);
+    size_t n = Profiler::count();
+    size_t shown = n < frames ? n : frames;
+    for (size_t k = 1; k < shown; ++k)
+    {
+        float a = Profiler::sample(n - shown + k - 1).intervalUs;
+        float b = Profiler::sample(n - shown + k).intervalUs;
+        int ya = y + h - (int)(h * (a < scaleUs ? a : scaleUs) / scaleUs);
+        int yb = y + h - (int)(h * (b < scaleUs ? b : scaleUs) / scaleUs);
+        DrawLine(x + (int)((k - 1) * w / frames), ya, x + (int)(k * w / frames), yb, GREEN);
+    }
+
+    int ty = y + h + 8;
+    DrawText(TextFormat("frame p50 %.2f ms  p99 %.2f ms", Profiler::intervalPercentile(frames, 0.5f) / 1000.0f,
+                        Profiler::intervalPercentile(frames, 0.99f) / 1000.0f),
+             x, ty, 20, LIGHTGRAY);
+    size_t i = n;
+    while (i > 0 && !Profiler::sample(i - 1).drawn)
+        --i;
+    if (i == 0)
+        return;
+    FrameSample last = Profiler::sample(i - 1);
+    for (int z = 0; z < ZoneCount; ++z)
+    {
+        ty += 22;
+        DrawText(TextFormat("%-12s %7.3f ms", Profiler::zoneName((ProfileZone)z), last.zoneUs[z] / 1000.0f), x, ty, 18,
+                 LIGHTGRAY);
+    }
 }
\ No newline at end of file
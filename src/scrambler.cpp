@@ -1,32 +1,180 @@
 #include "scrambler.h"
-#include <cstdlib>
-#include <ctime>
+#include "solver.h"
+#include "table_cache.h"
+#include <chrono>
+#include <random>
+
+namespace {
+
+uint64_t splitmix64(uint64_t &x)
+{
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// 交互打乱用的进程内随机源：只在第一次使用时播种一次，连续按 R 不会得到相同的打乱
+ScrambleRng &sessionRng()
+{
+    static ScrambleRng rng(std::random_device{}() ^
+                           (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count());
+    return rng;
+}
+
+// 随机排列 n 个元素（Fisher-Yates），返回排列的奇偶性（交换次数的奇偶）
+int shuffle(ScrambleRng &rng, uint8_t *p, int n)
+{
+    int parity = 0;
+    for (int i = n - 1; i > 0; --i)
+    {
+        int j = (int)rng.below((uint32_t)i + 1);
+        if (j != i)
+        {
+            uint8_t t = p[i];
+            p[i] = p[j];
+            p[j] = t;
+            parity ^= 1;
+        }
+    }
+    return parity;
+}
+
+// 指令里的 clockwise 是动画角度的正负方向：X/Z 轴与 rotateLayer 的方向相反（见 getVisualClockwise）
+MoveId commandMove(const RotationCommand &cmd)
+{
+    return moveFromLayer(cmd.axis, cmd.layer, cmd.axis == AxisY ? cmd.clockwise : !cmd.clockwise);
+}
+
+} // namespace
+
+ScrambleRng::ScrambleRng(uint64_t seed)
+{
+    for (uint64_t &w : s)
+        w = splitmix64(seed);
+}
+
+uint32_t ScrambleRng::below(uint32_t n)
+{
+    uint64_t m = (next() >> 32) * n;
+    uint32_t low = (uint32_t)m;
+    if (low < n)
+    {
+        uint32_t threshold = (0u - n) % n;
+        while (low < threshold)
+        {
+            m = (next() >> 32) * n;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+CubieState randomCubieState(ScrambleRng &rng)
+{
+    CubieState s = solvedCubieState();
+    uint8_t corners[8], edges[12];
+    for (int i = 0; i < 8; ++i)
+        corners[i] = (uint8_t)i;
+    for (int i = 0; i < 12; ++i)
+        edges[i] = (uint8_t)i;
+    int parity = shuffle(rng, corners, 8) ^ shuffle(rng, edges, 12);
+    // 角块与棱块排列的奇偶必须相同：不同时交换最后两个棱块
+    if (parity)
+    {
+        uint8_t t = edges[10];
+        edges[10] = edges[11];
+        edges[11] = t;
+    }
+    // 朝向：前 7 个角块 / 前 11 个棱块随机，最后一个由总和为 0 决定
+    int twist = 0, flip = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        int o = i < 7 ? (int)rng.below(3) : (3 - twist % 3) % 3;
+        twist += o;
+        s.b[CubieState::kCornerOffset + i] = (uint8_t)(corners[i] + o * 8);
+    }
+    for (int i = 0; i < 12; ++i)
+    {
+        int o = i < 11 ? (int)rng.below(2) : flip & 1;
+        flip += o;
+        s.b[CubieState::kEdgeOffset + i] = (uint8_t)(edges[i] + o * 16);
+    }
+    return s;
+}
+
+std::vector<MoveId> scrambleForState(const CubieState &state)
+{
+    Cube cube;
+    cube.setState(state);
+    std::vector<MoveId> moves = Solver::parseSolution(Solver::solveFacelets(Solver::encodeFacelets(cube)));
+    invertMoves(moves);
+    return moves;
+}
+
+std::vector<RotationCommand> toScrambleCommands(const std::vector<MoveId> &moves)
+{
+    std::vector<RotationCommand> out;
+    out.reserve(moves.size() * 2);
+    for (MoveId move : moves)
+    {
+        RotationCommand cmd;
+        layerFromMove(move, cmd.axis, cmd.layer, cmd.clockwise);
+        if (cmd.axis != AxisY)
+            cmd.clockwise = !cmd.clockwise;
+        // 180° 转动展开为两个 90° 指令
+        int times = movePower(move) == 1 ? 2 : 1;
+        for (int i = 0; i < times; ++i)
+            out.push_back(cmd);
+    }
+    return out;
+}
 
 // 生成 N 个随机合法的打乱指令序列（避免连续重复同一层）
 std::vector<RotationCommand> generateScramble(int count)
 {
+    ScrambleRng &rng = sessionRng();
     std::vector<RotationCommand> sequence;
     Axis lastAxis = AxisX;
     int lastLayer = -1;
 
-    std::srand((unsigned int)std::time(nullptr));
-
     for (int i = 0; i < count; ++i)
     {
         Axis axis;
         int layer;
         do
         {
-            axis = static_cast<Axis>(std::rand() % 3);
-            layer = std::rand() % 2;
-            if(layer == 1) layer = 2; // 只选0或2层 
+            axis = static_cast<Axis>(rng.below(3));
+            layer = rng.below(2) ? 2 : 0; // 只选0或2层
         } while (!sequence.empty() && axis == lastAxis && layer == lastLayer);
 
-        bool clockwise = std::rand() % 2 == 0;
+        bool clockwise = rng.below(2) == 0;
 
         sequence.push_back({axis, layer, clockwise});
         lastAxis = axis;
         lastLayer = layer;
     }
-    return sequence;
-}
\ No newline at end of file
+    return simplifyScramble(sequence);
+}
+
+std::vector<RotationCommand> generateRandomStateScramble()
+{
+    // 表还在后台构建时不阻塞主线程
+    if (!TableCache::isReady())
+        return generateScramble(20);
+    std::vector<MoveId> moves = scrambleForState(randomCubieState(sessionRng()));
+    // min2phase 出错（返回空解）时同样退回随机转动
+    if (moves.empty())
+        return generateScramble(20);
+    return toScrambleCommands(moves);
+}
+
+std::vector<RotationCommand> simplifyScramble(const std::vector<RotationCommand> &sequence)
+{
+    std::vector<MoveId> moves;
+    moves.reserve(sequence.size());
+    for (const auto &cmd : sequence)
+        moves.push_back(commandMove(cmd));
+    simplifyMoves(moves);
+    return toScrambleCommands(moves);
+}
@@ -0,0 +1,417 @@
+#include "solution_cache.h"
+#include "symmetry.h"
+#include "table_cache.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char kMagic[8] = {'R', 'B', 'K', 'S', 'O', 'L', '0', '1'};
+const uint32_t kVersion = 1;
+const size_t kHeaderSize = 16;
+const size_t kRecordHeader = 2 + sizeof(CubieState);
+const size_t kMaxMoves = 40;      // 超过的解不记录，扫描时也据此识别损坏的记录
+const size_t kLruCapacity = 4096;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+};
+
+// 规范形与它的解（规范形的朝向下）
+struct Entry {
+    CubieState key;
+    std::vector<MoveId> moves;
+    uint8_t quality;
+};
+
+// 磁盘记录在文件中的位置
+struct Slot {
+    size_t offset;
+    uint8_t length;
+    uint8_t quality;
+};
+
+bool better(uint8_t quality, size_t length, uint8_t oldQuality, size_t oldLength)
+{
+    return quality != oldQuality ? quality > oldQuality : length < oldLength;
+}
+
+// 规范形的中心都在原位，外层转动不会移动中心，复原即与复原状态逐字节相等
+bool solves(const CubieState &key, const std::vector<MoveId> &moves)
+{
+    CubieState s = key;
+    applySequence(s, moves.data(), moves.size());
+    return s == solvedCubieState();
+}
+
+// 24 种整体转动各自对外层转动的共轭（conjugateMoves 每次调用都要重新推导，这里只推导一次）：
+// toCaller[r][m] = r m r^-1，fromCaller 为其逆映射
+struct RotationMaps {
+    MoveId toCaller[24][MoveFaceCount];
+    MoveId fromCaller[24][MoveFaceCount];
+
+    RotationMaps()
+    {
+        const std::vector<std::vector<MoveId>> &rotations = cubeRotations();
+        for (size_t r = 0; r < rotations.size(); ++r)
+        {
+            std::vector<MoveId> moves;
+            for (int m = 0; m < MoveFaceCount; ++m)
+                moves.push_back((MoveId)m);
+            conjugateMoves(moves, rotations[r]);
+            for (int m = 0; m < MoveFaceCount; ++m)
+            {
+                toCaller[r][m] = moves[m];
+                fromCaller[r][moves[m]] = (MoveId)m;
+            }
+        }
+    }
+};
+
+const RotationMaps &rotationMaps()
+{
+    static const RotationMaps maps;
+    return maps;
+}
+
+// 先整体转动（cubeRotations() 中的第 rotation 个）使中心归位，再取规范形；中心排列不可能出现时返回 false
+bool canonicalKey(const CubieState &state, CubieState &key, size_t &rotation, int &symmetry)
+{
+    const std::vector<MoveId> *home = centerRotation(state);
+    if (!home)
+        return false;
+    rotation = (size_t)(home - cubeRotations().data());
+    CubieState base = state;
+    applySequence(base, home->data(), home->size());
+    key = canonicalState(base, &symmetry);
+    return true;
+}
+
+void mkdirs(const std::string &dir)
+{
+    for (size_t i = 1; i <= dir.size(); ++i)
+        if (i == dir.size() || dir[i] == '/')
+            mkdir(dir.substr(0, i).c_str(), 0755);
+}
+
+class Store {
+public:
+    ~Store()
+    {
+        if (data)
+            munmap(const_cast<uint8_t *>(data), mapped);
+        if (fd >= 0)
+            ::close(fd);
+    }
+
+    bool find(uint64_t hash, const CubieState &key, Entry &out)
+    {
+        ensureOpen();
+        auto hit = lruIndex.find(hash);
+        if (hit != lruIndex.end() && hit->second->key == key)
+        {
+            lru.splice(lru.begin(), lru, hit->second);
+            out = *hit->second;
+            return true;
+        }
+        auto slot = index.find(hash);
+        if (slot == index.end() || !read(slot->second, key, out))
+            return false;
+        remember(hash, out);
+        return true;
+    }
+
+    void add(uint64_t hash, const Entry &entry)
+    {
+        ensureOpen();
+        auto slot = index.find(hash);
+        if (slot != index.end() && !better(entry.quality, entry.moves.size(), slot->second.quality, slot->second.length))
+            return;
+        auto hit = lruIndex.find(hash);
+        if (hit != lruIndex.end() && hit->second->key == entry.key &&
+            !better(entry.quality, entry.moves.size(), hit->second->quality, hit->second->moves.size()))
+            return;
+        remember(hash, entry);
+        size_t offset;
+        if (append(entry, offset))
+            index[hash] = {offset, (uint8_t)entry.moves.size(), entry.quality};
+    }
+
+    // 一条解出错（磁盘损坏等）：从两层中都去掉
+    void drop(uint64_t hash)
+    {
+        auto hit = lruIndex.find(hash);
+        if (hit != lruIndex.end())
+        {
+            lru.erase(hit->second);
+            lruIndex.erase(hit);
+        }
+        index.erase(hash);
+    }
+
+    std::mutex mutex;
+    bool enabled = true;
+
+private:
+    void ensureOpen()
+    {
+        if (opened)
+            return;
+        opened = true;
+        std::string path = SolutionCache::cachePath();
+        size_t slash = path.rfind('/');
+        if (slash != std::string::npos)
+            mkdirs(path.substr(0, slash));
+        fd = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (fd < 0)
+        {
+            std::cout << "[SolutionCache] cannot open " << path << ", memory only" << std::endl;
+            return;
+        }
+        // 新文件写入文件头；文件锁保证并发启动的进程只写一次
+        flock(fd, LOCK_EX);
+        struct stat st;
+        bool ok = fstat(fd, &st) == 0;
+        if (ok && st.st_size == 0)
+        {
+            FileHeader h = {};
+            memcpy(h.magic, kMagic, sizeof(kMagic));
+            h.version = kVersion;
+            ok = write(fd, &h, sizeof(h)) == (ssize_t)sizeof(h);
+        }
+        flock(fd, LOCK_UN);
+        if (ok)
+            ok = remap();
+        FileHeader h;
+        if (ok && mapped >= kHeaderSize)
+        {
+            memcpy(&h, data, sizeof(h));
+            ok = memcmp(h.magic, kMagic, sizeof(kMagic)) == 0 && h.version == kVersion;
+        }
+        if (!ok)
+        {
+            std::cout << "[SolutionCache] " << path << " is not a solution cache, memory only" << std::endl;
+            ::close(fd);
+            fd = -1;
+            return;
+        }
+        scan();
+        std::cout << "[SolutionCache] loaded " << index.size() << " solutions from " << path << std::endl;
+    }
+
+    // 映射整个文件（本进程或其它进程追加后文件变长时重新映射）
+    bool remap()
+    {
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0)
+            return false;
+        if (data)
+            munmap(const_cast<uint8_t *>(data), mapped);
+        data = nullptr;
+        mapped = 0;
+        void *map = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED)
+            return false;
+        madvise(map, (size_t)st.st_size, MADV_RANDOM);
+        data = static_cast<const uint8_t *>(map);
+        mapped = (size_t)st.st_size;
+        return true;
+    }
+
+    // 建立索引：每个规范形取来源最好、其次最短的记录；遇到不完整或损坏的记录就停止
+    void scan()
+    {
+        size_t offset = kHeaderSize;
+        while (offset + kRecordHeader <= mapped)
+        {
+            const uint8_t *p = data + offset;
+            size_t n = p[0];
+            if (n > kMaxMoves || p[1] > QualityOptimal || offset + kRecordHeader + n > mapped)
+                break;
+            bool valid = true;
+            for (size_t k = 0; k < n; ++k)
+                valid = valid && p[kRecordHeader + k] < MoveFaceCount;
+            if (!valid)
+                break;
+            CubieState key;
+            memcpy(key.b, p + 2, sizeof(key.b));
+            uint64_t hash = zobristHash(key);
+            auto slot = index.find(hash);
+            if (slot == index.end() || better(p[1], n, slot->second.quality, slot->second.length))
+                index[hash] = {offset, (uint8_t)n, p[1]};
+            offset += kRecordHeader + n;
+        }
+        if (offset == mapped)
+            return;
+        // 上次写入中断留下的半条记录：截掉，否则之后追加的记录都排在它后面、扫描不到
+        std::cout << "[SolutionCache] dropping " << mapped - offset << " trailing bytes" << std::endl;
+        flock(fd, LOCK_EX);
+        struct stat st;
+        if (fstat(fd, &st) == 0 && (size_t)st.st_size == mapped && ftruncate(fd, (off_t)offset) == 0)
+            remap();
+        flock(fd, LOCK_UN);
+    }
+
+    bool read(const Slot &slot, const CubieState &key, Entry &out)
+    {
+        if (slot.offset + kRecordHeader + slot.length > mapped && !remap())
+            return false;
+        if (slot.offset + kRecordHeader + slot.length > mapped)
+            return false;
+        const uint8_t *p = data + slot.offset;
+        if (memcmp(p + 2, key.b, sizeof(key.b)) != 0)
+            return false;
+        out.key = key;
+        out.quality = p[1];
+        out.moves.resize(p[0]);
+        for (size_t k = 0; k < out.moves.size(); ++k)
+            out.moves[k] = static_cast<MoveId>(p[kRecordHeader + k]);
+        return true;
+    }
+
+    bool append(const Entry &entry, size_t &offset)
+    {
+        if (fd < 0)
+            return false;
+        uint8_t record[kRecordHeader + kMaxMoves];
+        size_t n = entry.moves.size();
+        record[0] = (uint8_t)n;
+        record[1] = entry.quality;
+        memcpy(record + 2, entry.key.b, sizeof(entry.key.b));
+        for (size_t k = 0; k < n; ++k)
+            record[kRecordHeader + k] = (uint8_t)entry.moves[k];
+        // O_APPEND 的一次 write 整条落在文件末尾；加锁后记录的偏移才是确定的
+        flock(fd, LOCK_EX);
+        bool ok = write(fd, record, kRecordHeader + n) == (ssize_t)(kRecordHeader + n);
+        struct stat st;
+        ok = ok && fstat(fd, &st) == 0;
+        flock(fd, LOCK_UN);
+        if (!ok)
+            return false;
+        offset = (size_t)st.st_size - kRecordHeader - n;
+        return true;
+    }
+
+    void remember(uint64_t hash, const Entry &entry)
+    {
+        auto hit = lruIndex.find(hash);
+        if (hit != lruIndex.end())
+        {
+            lru.erase(hit->second);
+            lruIndex.erase(hit);
+        }
+        lru.push_front(entry);
+        lruIndex[hash] = lru.begin();
+        if (lru.size() > kLruCapacity)
+        {
+            lruIndex.erase(zobristHash(lru.back().key));
+            lru.pop_back();
+        }
+    }
+
+    bool opened = false;
+    int fd = -1;
+    const uint8_t *data = nullptr;
+    size_t mapped = 0;
+    std::unordered_map<uint64_t, Slot> index;
+    std::list<Entry> lru;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> lruIndex;
+};
+
+Store &store()
+{
+    static Store s;
+    return s;
+}
+
+} // namespace
+
+bool SolutionCache::lookup(const CubieState &state, std::vector<MoveId> &moves, SolutionQuality *quality)
+{
+    CubieState key;
+    size_t rotation;
+    int symmetry;
+    if (!canonicalKey(state, key, rotation, symmetry) || key == solvedCubieState())
+        return false;
+    uint64_t hash = zobristHash(key);
+    Entry entry;
+    {
+        Store &s = store();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.enabled || !s.find(hash, key, entry))
+            return false;
+        if (!solves(key, entry.moves))
+        {
+            s.drop(hash);
+            return false;
+        }
+    }
+    // 规范形的解 -> 中心归位后的解 -> 调用方的朝向
+    moves = entry.moves;
+    conjugateMoves(moves, inverseSymmetry(symmetry));
+    const MoveId *toCaller = rotationMaps().toCaller[rotation];
+    for (MoveId &m : moves)
+        m = toCaller[m];
+    if (quality)
+        *quality = static_cast<SolutionQuality>(entry.quality);
+    return true;
+}
+
+void SolutionCache::insert(const CubieState &state, const std::vector<MoveId> &moves, SolutionQuality quality)
+{
+    if (moves.size() > kMaxMoves)
+        return;
+    for (MoveId m : moves)
+        if (m >= MoveFaceCount)
+            return;
+    Entry entry;
+    size_t rotation;
+    int symmetry;
+    if (!canonicalKey(state, entry.key, rotation, symmetry) || entry.key == solvedCubieState())
+        return;
+    // lookup 的反方向：调用方朝向的解 -> 中心归位后的解 -> 规范形的解
+    const MoveId *fromCaller = rotationMaps().fromCaller[rotation];
+    entry.moves = moves;
+    for (MoveId &m : entry.moves)
+        m = fromCaller[m];
+    conjugateMoves(entry.moves, symmetry);
+    entry.quality = quality;
+    if (!solves(entry.key, entry.moves))
+        return;
+    Store &s = store();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (s.enabled)
+        s.add(zobristHash(entry.key), entry);
+}
+
+std::string SolutionCache::cachePath()
+{
+    if (const char *p = getenv("RUBIK_SOLUTION_CACHE"))
+        return p;
+    return TableCache::cacheDir() + "/solutions-v" + std::to_string(kVersion) + ".bin";
+}
+
+void SolutionCache::setEnabled(bool enabled)
+{
+    Store &s = store();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.enabled = enabled;
+}
+
+bool SolutionCache::isEnabled()
+{
+    Store &s = store();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.enabled;
+}
@@ -1,163 +1,417 @@
 #include "solver.h"
+#include "optimal_solver.h"
+#include "table_cache.h"
+#include "profiler.h"
+#include "solution_cache.h"
+#include "state_validator.h"
+#include "thread_pool.h"
 #include "min2phase/min2phase.h"
-#include <map>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <iostream>
 
-// 生成贴纸颜色 → face 字母的映射表（中心块为基准）
-static std::map<Color, char> getColorToFaceMap(const Cube &cube)
+namespace {
+
+const char kFaceletLetters[] = "URFDLB";
+
+// facelet 字母按中心块重新映射：letter 为贴纸原本所属面的字母，
+// 返回当前中心在同一面上的 facelet 字母（中心都在原位时 map 为恒等）
+struct CenterMap {
+    char map[128];
+
+    explicit CenterMap(const uint8_t *letters)
+    {
+        for (int k = 0; k < 6; ++k)
+            map[letters[k * 9 + 4]] = kFaceletLetters[k];
+    }
+};
+
+bool centersHome(const uint8_t *letters)
+{
+    for (int k = 0; k < 6; ++k)
+        if (letters[k * 9 + 4] != (uint8_t)kFaceletLetters[k])
+            return false;
+    return true;
+}
+
+using Clock = std::chrono::steady_clock;
+
+// 缓存中可以回答该引擎请求的最低来源
+SolutionQuality requiredQuality(SolverEngine engine)
+{
+    switch (engine)
+    {
+    case SolverOptimal:
+        return QualityOptimal;
+    case SolverPortfolio:
+    case SolverAnytime:
+        return QualityPortfolio;
+    default:
+        return QualityTwoPhase;
+    }
+}
+
+// 组合求解的一个变体：先整体转动 rotation，inverse 时求解的是逆状态
+struct Variant {
+    const std::vector<MoveId> *rotation;
+    bool inverse;
+};
+
+// 朝向按“哪个轴转到了 UD 方向”轮流排列（min2phase 第一阶段按 UD 轴划分，换轴的变体差别最大）
+std::vector<Variant> portfolioVariants(size_t count)
+{
+    const std::vector<std::vector<MoveId>> &rotations = cubeRotations();
+    std::vector<const std::vector<MoveId> *> byAxis[3];
+    for (const std::vector<MoveId> &r : rotations)
+    {
+        CubieState s = solvedCubieState();
+        applySequence(s, r.data(), r.size());
+        byAxis[s.b[CubieState::kCenterOffset + UP] / 2].push_back(&r);
+    }
+    // 恒等朝向的 UD 轴是 Y，排在最前
+    const int order[3] = {AxisY, AxisX, AxisZ};
+    std::vector<Variant> out;
+    for (size_t k = 0; out.size() < count && k < 8; ++k)
+        for (int a : order)
+            for (bool inverse : {false, true})
+                if (out.size() < count && k < byAxis[a].size())
+                    out.push_back({byAxis[a][k], inverse});
+    return out;
+}
+
+ThreadPool &portfolioPool()
 {
-    std::map<Color, char> colorMap;
-    // 中心块：6 个面的中间块
-    // 默认顺序：U R F D L B
-    std::vector<std::tuple<Face, int, int, int, char>> centers = {
-        {UP, 1, 2, 1, 'U'},
-        {RIGHT, 2, 1, 1, 'R'},
-        {FRONT, 1, 1, 2, 'F'},
-        {DOWN, 1, 0, 1, 'D'},
-        {LEFT, 0, 1, 1, 'L'},
-        {BACK, 1, 1, 0, 'B'}};
-
-    for (auto &[face, x, y, z, letter] : centers)
-    {
-        CubePiece *piece = cube.getPiece(x, y, z);
-        Color c = piece->faceColor[face];
-        colorMap[c] = letter;
-    }
-    return colorMap;
+    static ThreadPool pool;
+    return pool;
+}
+
+// 一次组合求解的共享状态；调用方返回时置 stop，还在跑的变体仍持有它，跑完当前这次 min2phase 调用就退出，
+// 还没开始的变体直接退出，不会占着线程池让下一次请求排队
+struct Portfolio {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::atomic<bool> stop{false};
+    const std::atomic<bool> *cancel = nullptr;  // 调用方的取消标志
+    Clock::time_point deadline;
+    size_t running = 0;
+    bool found = false;
+    std::vector<MoveId> best;
+    std::atomic<int> bestLength{100};
+    std::function<void(const std::vector<MoveId> &)> publish; // 调用方返回时清空
+};
+
+// base 的中心在原位；home 为把调用方的状态转到 base 的整体转动，解最后按它共轭回去
+void solveVariant(const std::shared_ptr<Portfolio> &p, const CubieState &base, const std::vector<MoveId> &home,
+                  Variant v, int probeMax, int tightenProbeMax)
+{
+    Cube cube;
+    cube.setState(v.inverse ? inverseState(base) : base);
+    cube.applySequence(*v.rotation);
+    const std::string facelets = Solver::encodeFacelets(cube);
+    int maxDepth = 21;
+    while (true)
+    {
+        int target = std::min(maxDepth, p->bestLength.load() - 1);
+        if (target < 1 || p->stop.load() || (p->cancel && p->cancel->load()))
+            break;
+        bool found;
+        {
+            std::lock_guard<std::mutex> lock(p->mutex);
+            if (p->found && Clock::now() >= p->deadline)
+                break;
+            found = p->found;
+        }
+        std::string sol = Solver::solveFacelets(facelets, target, found ? std::min(probeMax, tightenProbeMax) : probeMax);
+        // 更短的解找不到了（或超出 probe 上限）
+        if (sol.compare(0, 5, "Error") == 0)
+            break;
+        // 中心归位的外层转动 -> 整体转动前 -> 逆状态的解取逆 -> 调用方的朝向
+        std::vector<MoveId> moves = Solver::parseSolution(sol);
+        conjugateMoves(moves, *v.rotation);
+        if (v.inverse)
+            invertMoves(moves);
+        conjugateMoves(moves, home);
+        simplifyMoves(moves);
+        if ((int)moves.size() > target)
+            break;
+        std::lock_guard<std::mutex> lock(p->mutex);
+        if (!p->found || moves.size() < p->best.size())
+        {
+            p->found = true;
+            p->best = moves;
+            p->bestLength.store((int)moves.size());
+            if (p->publish)
+                p->publish(p->best);
+            p->changed.notify_all();
+        }
+        maxDepth = (int)moves.size() - 1;
+    }
+    std::lock_guard<std::mutex> lock(p->mutex);
+    --p->running;
+    p->changed.notify_all();
 }
 
+} // namespace
+
 std::string Solver::encodeFacelets(const Cube &cube)
 {
-    std::ostringstream result;
-    auto colorMap = getColorToFaceMap(cube);
-
-    // facelet 输出顺序：U R F D L B（每面按从左上到右下顺序）
-    std::vector<Face> faceOrder = {UP, RIGHT, FRONT, DOWN, LEFT, BACK};
-
-    for (Face face : faceOrder)
-    {
-        for (int i = 0; i < 3; ++i)
-        { // row
-            for (int j = 0; j < 3; ++j)
-            { // col
-                int x, y, z;
-                switch (face)
-                {
-                case UP:
-                    x = j;
-                    y = 2;
-                    z = i;
-                    break;
-                /**************//**************/
-                case DOWN:
-                    x = j;
-                    y = 0;
-                    z = 2 - i;
-                /**************//**************/
-                    break;
-                case LEFT:
-                    x = 0;
-                    y = 2 - i;
-                    z = j;
-                    break;
-                case RIGHT:
-                    x = 2;
-                    y = 2 - i;
-                    z = 2 - j;
-                    break;
-                case FRONT:
-                    x = j;
-                    y = 2 - i;
-                    z = 2;
-                    break;
-                case BACK:
-                    x = 2 - j;
-                    y = 2 - i;
-                    z = 0;
-                    break;
-                }
-                CubePiece *piece = cube.getPiece(x, y, z);
-                Color color = piece->faceColor[face];
-                char c = colorMap.count(color) ? colorMap[color] : '?';
-                result << c;
-            }
+    std::array<char, 54> out;
+    encodeFacelets(cube, out);
+    return std::string(out.data(), out.size());
+}
+
+void Solver::encodeFacelets(const Cube &cube, std::array<char, 54> &out)
+{
+    // 每个贴纸原本所属面的字母：跟踪中的魔方直接取，否则由小块状态查表得到
+    uint8_t letters[54];
+    if (const FaceletState *tracked = cube.facelets())
+    {
+        if (centersHome(tracked->f))
+        {
+            memcpy(out.data(), tracked->f, 54);
+            return;
+        }
+        memcpy(letters, tracked->f, 54);
+    }
+    else
+    {
+        stickerHomes(cube.state(), letters);
+        for (int i = 0; i < 54; ++i)
+            letters[i] = (uint8_t)faceLetter(letters[i]);
+        if (centersHome(letters))
+        {
+            memcpy(out.data(), letters, 54);
+            return;
         }
     }
+    // 中心块被中层转动或整体翻转移动过：按中心重新命名
+    CenterMap centers(letters);
+    for (int i = 0; i < 54; ++i)
+        out[i] = centers.map[letters[i]];
+}
+
+bool Solver::decodeFacelets(const std::string &facelets, CubieState &state)
+{
+    if (facelets.size() != 54)
+        return false;
+    int8_t faceOf[128];
+    memset(faceOf, -1, sizeof(faceOf));
+    for (int f = 0; f < 6; ++f)
+        faceOf[(int)faceLetter(f)] = (int8_t)f;
+    int8_t home[54];
+    for (int i = 0; i < 54; ++i)
+    {
+        unsigned char c = (unsigned char)facelets[i];
+        home[i] = c < 128 ? faceOf[c] : -1;
+        if (home[i] < 0)
+            return false;
+    }
 
-    return result.str();
+    // 每个状态字节逐一尝试所有取值，保留与落在它上面的贴纸全部吻合的那个
+    state = solvedCubieState();
+    uint32_t seenCorners = 0, seenEdges = 0;
+    for (int byte = 0; byte < CubieState::kEdgeOffset + 12; ++byte)
+    {
+        if (byte >= CubieState::kCenterOffset + 6 && byte < CubieState::kEdgeOffset)
+            continue;
+        int values = byte < CubieState::kCenterOffset ? 24 : byte < CubieState::kEdgeOffset ? 6 : 32;
+        int match = -1;
+        for (int v = 0; v < values && match < 0; ++v)
+        {
+            if (byte >= CubieState::kEdgeOffset && (v & 15) >= 12)
+                continue;
+            bool ok = true;
+            for (int i = 0; i < 54 && ok; ++i)
+            {
+                FaceletSource src = faceletSource(i);
+                if (src.byte == byte && src.home[v] != home[i])
+                    ok = false;
+            }
+            if (ok)
+                match = v;
+        }
+        if (match < 0)
+            return false;
+        state.b[byte] = (uint8_t)match;
+        if (byte < CubieState::kCenterOffset)
+            seenCorners |= 1u << (match & 7);
+        else if (byte >= CubieState::kEdgeOffset)
+            seenEdges |= 1u << (match & 15);
+    }
+    return seenCorners == 0xFF && seenEdges == 0xFFF;
 }
 
-std::vector<RotationCommandSolver> Solver::solve(const Cube &cube)
+std::vector<RotationCommandSolver> Solver::solve(const Cube &cube, SolverEngine engine, double budgetSeconds,
+                                                 const std::atomic<bool> *cancel)
 {
-    min2phase::init();
+    ProfileScope scope(ZoneSolve);
+    if (StateError error = validateState(cube.state()))
+    {
+        std::cout << "[Solver] invalid state: " << stateErrorMessage(error) << std::endl;
+        return {};
+    }
+    if (budgetSeconds <= 0)
+        budgetSeconds = defaultBudget(engine);
+    std::vector<MoveId> cached;
+    SolutionQuality quality;
+    if (SolutionCache::lookup(cube.state(), cached, &quality) && quality >= requiredQuality(engine))
+    {
+        std::cout << "[SolutionCache] hit, " << cached.size() << " moves" << std::endl;
+        return toCommands(cached);
+    }
+    if (engine == SolverPortfolio || engine == SolverAnytime)
+    {
+        PortfolioOptions options;
+        options.budgetSeconds = budgetSeconds;
+        Clock::time_point t0 = Clock::now();
+        std::vector<MoveId> moves = solvePortfolio(cube, options, nullptr, cancel);
+        if (cancel && cancel->load())
+            return {};
+        char buf[160];
+        snprintf(buf, sizeof(buf), "[Portfolio] %zu moves from %zu variants, %.3f s", moves.size(), options.variants,
+                 std::chrono::duration<double>(Clock::now() - t0).count());
+        std::cout << buf << std::endl;
+        SolutionCache::insert(cube.state(), moves, QualityPortfolio);
+        return toCommands(moves);
+    }
+    if (engine == SolverOptimal)
+    {
+        OptimalResult r = OptimalSolver::solve(cube.state(), budgetSeconds, 0, cancel);
+        if (cancel && cancel->load())
+            return {};
+        char buf[160];
+        if (r.solved)
+        {
+            snprintf(buf, sizeof(buf), "[Optimal] %zu moves, %llu nodes, %.2f s", r.moves.size(),
+                     (unsigned long long)r.nodes, r.seconds);
+            std::cout << buf << std::endl;
+            SolutionCache::insert(cube.state(), r.moves, QualityOptimal);
+            return toCommands(r.moves);
+        }
+        snprintf(buf, sizeof(buf), "[Optimal] no solution within %.1f s (optimal >= %d moves), using min2phase",
+                 budgetSeconds, r.depth + 1);
+        std::cout << buf << std::endl;
+    }
+
     std::string facelets = encodeFacelets(cube);
     std::cout << "[Facelets] " << facelets << std::endl;
 
-    std::string sol = min2phase::solve(facelets, 21, 1000000, 0, min2phase::APPEND_LENGTH);
+    std::string sol = solveFacelets(facelets);
     std::cout << "[Raw Solution] " << sol << std::endl;
 
-    std::vector<RotationCommandSolver> cmds;
-    std::istringstream ss(sol);
-    std::string move;
+    // min2phase 的解一般已无可化简之处，但求解器可能换成别的实现，统一在出口化简一次
+    std::vector<MoveId> moves = parseSolution(sol);
+    if (size_t removed = simplifyMoves(moves))
+        std::cout << "[Simplified] -" << removed << " moves" << std::endl;
+    SolutionCache::insert(cube.state(), moves, QualityTwoPhase);
+    return toCommands(moves);
+}
 
-    while (ss >> move)
+double Solver::defaultBudget(SolverEngine engine)
+{
+    switch (engine)
     {
-        if (move == "=>")
-            break;
-        char face = move[0];
-        int times = 1;
-        bool clockwise = true;
+    case SolverOptimal:
+        return 30.0;
+    case SolverPortfolio:
+        return PortfolioOptions().budgetSeconds;
+    case SolverAnytime:
+        return 3.0;
+    default:
+        return 0.0;
+    }
+}
 
-        if (move.length() == 2)
-        {
-            if (move[1] == '\'')
-                clockwise = false;
-            else if (move[1] == '2')
-                times = 2;
-        }
+std::vector<MoveId> Solver::solvePortfolio(const Cube &cube, const PortfolioOptions &options,
+                                           const std::function<void(const std::vector<MoveId> &)> &onImprove,
+                                           const std::atomic<bool> *cancel)
+{
+    if (cube.isSolved())
+        return {};
+    Clock::time_point t0 = Clock::now();
+    const std::vector<MoveId> *home = centerRotation(cube.state());
+    if (!home)
+        return {};
+    CubieState base = cube.state();
+    applySequence(base, home->data(), home->size());
 
-        Axis axis;
-        int layer;
+    std::vector<Variant> variants = portfolioVariants(std::max<size_t>(1, options.variants));
+    auto p = std::make_shared<Portfolio>();
+    p->deadline = t0 + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.budgetSeconds));
+    p->running = variants.size();
+    p->publish = onImprove;
+    p->cancel = cancel;
+    ThreadPool &pool = portfolioPool();
+    for (Variant v : variants)
+    {
+        int probeMax = options.probeMax, tightenProbeMax = options.tightenProbeMax;
+        pool.submit([p, base, home, v, probeMax, tightenProbeMax] {
+            solveVariant(p, base, *home, v, probeMax, tightenProbeMax);
+        });
+    }
 
-        switch (face)
-        {
-        case 'U':
-            axis = AxisY;
-            layer = 2;
-            clockwise = !clockwise;
-            break;
-        case 'D':
-            axis = AxisY;
-            layer = 0;
-            break;
-        case 'L':
-            axis = AxisX;
-            layer = 0;
-            break;
-        case 'R':
-            axis = AxisX;
-            layer = 2;
-            clockwise = !clockwise;
-            break;
-        case 'F':
-            axis = AxisZ;
-            layer = 2;
-            clockwise = !clockwise;
-            break;
-        case 'B':
-            axis = AxisZ;
-            layer = 0;
+    // 取消标志没有人通知条件变量，按小段等待并检查
+    auto cancelled = [&] { return cancel && cancel->load(); };
+    const Clock::duration slice = std::chrono::milliseconds(5);
+    std::unique_lock<std::mutex> lock(p->mutex);
+    while (p->running != 0 && !cancelled() && Clock::now() < p->deadline)
+        p->changed.wait_until(lock, std::min(p->deadline, Clock::now() + slice));
+    while (!p->found && p->running != 0 && !cancelled())
+        p->changed.wait_for(lock, slice);
+    p->publish = nullptr;
+    p->stop.store(true);
+    return p->best;
+}
+
+std::string Solver::solveFacelets(const std::string &facelets, int maxDepth, int probeMax)
+{
+    // 不可能复原的状态立即返回同样的错误码，不进入搜索
+    if (StateError error = validateFacelets(facelets))
+        return "Error " + std::to_string((int)error);
+    TableCache::ensureReady();
+    return min2phase::solve(facelets, (int8_t)maxDepth, probeMax, 0, min2phase::APPEND_LENGTH);
+}
+
+std::vector<MoveId> Solver::parseSolution(const std::string &sol)
+{
+    std::vector<MoveId> moves;
+    std::istringstream ss(sol);
+    std::string token;
+    while (ss >> token)
+    {
+        if (token == "=>")
             break;
-        default:
-            continue;
-        }
+        MoveId move;
+        // 长度标记 "(21f)" 等非转动记号直接跳过
+        if (parseMove(token.c_str(), move))
+            moves.push_back(move);
+    }
+    return moves;
+}
 
+std::vector<RotationCommandSolver> Solver::toCommands(const std::vector<MoveId> &moves)
+{
+    std::vector<RotationCommandSolver> cmds;
+    cmds.reserve(moves.size() * 2);
+    for (MoveId move : moves)
+    {
+        Axis axis;
+        int layer;
+        bool clockwise;
+        layerFromMove(move, axis, layer, clockwise);
+        // 指令里的 clockwise 是动画角度的正负方向：X/Z 轴与 rotateLayer 的方向相反（见 getVisualClockwise）
+        if (axis != AxisY)
+            clockwise = !clockwise;
+        int times = movePower(move) == 1 ? 2 : 1;
         for (int i = 0; i < times; ++i)
-        {
             cmds.push_back({axis, layer, clockwise});
-        }
     }
-
     return cmds;
-}
\ No newline at end of file
+}
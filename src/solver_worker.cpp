@@ -0,0 +1,218 @@
+#include "solver_worker.h"
+#include "solution_cache.h"
+#include "state_validator.h"
+#include "table_cache.h"
+#include <iostream>
+
+SolverWorker::SolverWorker()
+    : quit(false), hasJob(false), jobScramble(false), hasResult(false), generation(0), stopJob(false),
+      jobEngine(SolverTwoPhase),
+      jobBudget(0), jobGeneration(0), resultGeneration(0), hasStream(false), streamFinal(false), hasScramble(false)
+{
+    thread = std::thread(&SolverWorker::run, this);
+}
+
+SolverWorker::~SolverWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+        stopJob.store(true);
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+uint64_t SolverWorker::submit(const Cube &cube, SolverEngine engine, double budgetSeconds)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    job = cube;
+    jobEngine = engine;
+    jobBudget = budgetSeconds;
+    jobGeneration = ++generation;
+    stopJob.store(true);
+    hasJob = true;
+    jobScramble = false;
+    hasResult = false;
+    hasStream = false;
+    streamFinal = false;
+    streamMoves.clear();
+    hasScramble = false;
+    wake.notify_one();
+    return jobGeneration;
+}
+
+uint64_t SolverWorker::submitScramble()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    jobGeneration = ++generation;
+    stopJob.store(true);
+    hasJob = true;
+    jobScramble = true;
+    hasResult = false;
+    hasStream = false;
+    streamFinal = false;
+    streamMoves.clear();
+    hasScramble = false;
+    wake.notify_one();
+    return jobGeneration;
+}
+
+void SolverWorker::cancel()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ++generation;
+    stopJob.store(true);
+    hasJob = false;
+    hasResult = false;
+    hasStream = false;
+    streamFinal = false;
+    streamMoves.clear();
+    hasScramble = false;
+}
+
+bool SolverWorker::busy() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    // 最新请求还在排队、正在求解或结果未取走
+    return hasJob || hasResult || hasStream || hasScramble ||
+           (jobGeneration == generation && resultGeneration != generation);
+}
+
+bool SolverWorker::poll(std::vector<RotationCommandSolver> &solution, Cube &snapshot)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!hasResult)
+        return false;
+    solution.swap(result);
+    result.clear();
+    snapshot = resultSnapshot;
+    hasResult = false;
+    return true;
+}
+
+bool SolverWorker::pollStream(std::vector<MoveId> &moves, Cube &snapshot, bool &final)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!hasStream)
+        return false;
+    moves = streamMoves;
+    snapshot = resultSnapshot;
+    final = streamFinal;
+    hasStream = false;
+    return true;
+}
+
+bool SolverWorker::pollScramble(std::vector<RotationCommand> &scramble)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!hasScramble)
+        return false;
+    scramble.swap(scrambleResult);
+    scrambleResult.clear();
+    hasScramble = false;
+    return true;
+}
+
+void SolverWorker::run()
+{
+    TableCache::ensureReady();
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, [this] { return quit || hasJob; });
+        if (quit)
+            return;
+        Cube cube = job;
+        SolverEngine engine = jobEngine;
+        double budget = jobBudget;
+        uint64_t gen = jobGeneration;
+        bool scramble = jobScramble;
+        hasJob = false;
+        stopJob.store(false);
+
+        if (scramble)
+        {
+            lock.unlock();
+            std::vector<RotationCommand> commands = generateRandomStateScramble();
+            lock.lock();
+            resultGeneration = gen;
+            if (gen != generation)
+                continue;
+            scrambleResult.swap(commands);
+            hasScramble = true;
+            continue;
+        }
+
+        // 分派给任何引擎之前先检查一次（常数时间，不必放锁）：不可能复原的状态立即作为空结果发布，
+        // 而不是让 portfolio 的每个变体各自把预算耗完
+        if (StateError error = validateState(cube.state()))
+        {
+            std::cout << "[Solver] invalid state: " << stateErrorMessage(error) << std::endl;
+            resultGeneration = gen;
+            resultSnapshot = cube;
+            if (engine == SolverAnytime)
+            {
+                streamMoves.clear();
+                streamFinal = true;
+                hasStream = true;
+            }
+            else
+            {
+                result.clear();
+                hasResult = true;
+            }
+            continue;
+        }
+
+        if (engine == SolverAnytime)
+        {
+            lock.unlock();
+            // 缓存命中时不再搜索，直接作为最终结果发布；最终结果总是本次请求自己的，不沿用上一次留下的 streamMoves
+            std::vector<MoveId> best;
+            SolutionQuality quality;
+            if (SolutionCache::lookup(cube.state(), best, &quality) && quality >= QualityPortfolio)
+                std::cout << "[SolutionCache] hit, " << best.size() << " moves" << std::endl;
+            else
+            {
+                PortfolioOptions options;
+                options.budgetSeconds = budget > 0 ? budget : Solver::defaultBudget(engine);
+                // 每个更短的解都立即发布；期间被取消或有了新请求就不再发布
+                best = Solver::solvePortfolio(
+                    cube, options,
+                    [&](const std::vector<MoveId> &moves) {
+                        std::lock_guard<std::mutex> guard(mutex);
+                        if (gen != generation)
+                            return;
+                        streamMoves = moves;
+                        resultSnapshot = cube;
+                        hasStream = true;
+                    },
+                    &stopJob);
+                if (!stopJob.load())
+                    SolutionCache::insert(cube.state(), best, QualityPortfolio);
+            }
+            lock.lock();
+            resultGeneration = gen;
+            if (gen != generation)
+                continue;
+            streamMoves = best;
+            resultSnapshot = cube;
+            streamFinal = true;
+            hasStream = true;
+            continue;
+        }
+
+        lock.unlock();
+        std::vector<RotationCommandSolver> solution = Solver::solve(cube, engine, budget, &stopJob);
+        lock.lock();
+
+        // 期间被取消或有了更新的请求：丢弃本次结果
+        resultGeneration = gen;
+        if (gen != generation)
+            continue;
+        result.swap(solution);
+        resultSnapshot = cube;
+        hasResult = true;
+    }
+}
@@ -0,0 +1,215 @@
+#include "state_validator.h"
+#include "moves.h"
+#include <cstring>
+
+namespace {
+
+const char kFaceletLetters[] = "URFDLB";
+
+struct ValidatorTables {
+    // facelet 字母 -> 贴纸原本所属的面（Face），其它字符为 -1
+    int8_t faceOf[256];
+    // 每个状态字节上的 facelet（按 facelet 序号排列），以及它们的颜色组合 -> 字节取值（不存在为 0xFF）；
+    // 颜色组合编码为 Σ face * 6^k
+    uint8_t faceletCount[32];
+    uint8_t facelets[32][3];
+    uint8_t valueOf[32][216];
+    // 24 种合法的中心排列，每种把 6 个字节压成 3 位一个
+    uint32_t centerKeys[24];
+    int centerKeyCount;
+
+    ValidatorTables()
+    {
+        memset(faceOf, -1, sizeof(faceOf));
+        for (int f = 0; f < 6; ++f)
+            faceOf[(uint8_t)faceLetter(f)] = (int8_t)f;
+
+        memset(faceletCount, 0, sizeof(faceletCount));
+        memset(valueOf, 0xFF, sizeof(valueOf));
+        for (int i = 0; i < 54; ++i)
+        {
+            int byte = faceletSource(i).byte;
+            facelets[byte][faceletCount[byte]++] = (uint8_t)i;
+        }
+        for (int byte = 0; byte < 32; ++byte)
+        {
+            if (faceletCount[byte] == 0)
+                continue;
+            for (int v = 0; v < 32; ++v)
+            {
+                if (byte < CubieState::kCenterOffset ? v >= 24 : byte < CubieState::kEdgeOffset ? v >= 6 : (v & 15) >= 12)
+                    continue;
+                int key = 0;
+                for (int k = faceletCount[byte] - 1; k >= 0; --k)
+                    key = key * 6 + faceletSource(facelets[byte][k]).home[v];
+                valueOf[byte][key] = (uint8_t)v;
+            }
+        }
+
+        centerKeyCount = 0;
+        for (const std::vector<MoveId> &rotation : cubeRotations())
+        {
+            CubieState s = solvedCubieState();
+            applySequence(s, rotation.data(), rotation.size());
+            centerKeys[centerKeyCount++] = centerKey(s);
+        }
+    }
+
+    static uint32_t centerKey(const CubieState &s)
+    {
+        uint32_t key = 0;
+        for (int i = 0; i < 6; ++i)
+            key |= (uint32_t)(s.b[CubieState::kCenterOffset + i] & 7) << (3 * i);
+        return key;
+    }
+};
+
+const ValidatorTables &tables()
+{
+    static const ValidatorTables t;
+    return t;
+}
+
+// 排列的奇偶性 = (n - 轮换个数) mod 2，每个元素只访问一次（ids 须为 0..n-1 的排列）
+int parity(const uint8_t *ids, int n)
+{
+    uint32_t seen = 0;
+    int cycles = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        if (seen >> i & 1)
+            continue;
+        ++cycles;
+        for (int j = i; !(seen >> j & 1); j = ids[j])
+            seen |= 1u << j;
+    }
+    return (n - cycles) & 1;
+}
+
+// 解码后的检查，按 min2phase 的顺序：棱块存在、翻转、角块存在、扭转、奇偶性；
+// badEdge / badCorner 表示 facelet 解码时已有对不上的颜色组合
+StateError check(const CubieState &s, bool badEdge, bool badCorner)
+{
+    uint8_t edges[12], corners[8], centers[6];
+    uint32_t seen = 0;
+    int flip = 0;
+    for (int i = 0; i < 12; ++i)
+    {
+        uint8_t v = s.b[CubieState::kEdgeOffset + i];
+        edges[i] = v & 15;
+        seen |= 1u << edges[i];
+        flip += v >> 4;
+    }
+    if (badEdge || seen != 0xFFF)
+        return StateEdges;
+    if (flip % 2 != 0)
+        return StateFlip;
+
+    seen = 0;
+    int twist = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        uint8_t v = s.b[CubieState::kCornerOffset + i];
+        corners[i] = v & 7;
+        seen |= 1u << corners[i];
+        twist += v >> 3;
+    }
+    if (badCorner || seen != 0xFF)
+        return StateCorners;
+    if (twist % 3 != 0)
+        return StateTwist;
+
+    const ValidatorTables &t = tables();
+    uint32_t key = ValidatorTables::centerKey(s);
+    bool centersOk = false;
+    for (int k = 0; k < t.centerKeyCount; ++k)
+        centersOk = centersOk || t.centerKeys[k] == key;
+    if (!centersOk)
+        return StateCenters;
+    // 外层转动同时改变角块与棱块排列的奇偶性，中层转动同时改变棱块与中心，三者的奇偶性之和不变
+    memcpy(centers, s.b + CubieState::kCenterOffset, 6);
+    if (parity(corners, 8) ^ parity(edges, 12) ^ parity(centers, 6))
+        return StateParity;
+    return StateOk;
+}
+
+} // namespace
+
+StateError validateFacelets(const std::string &facelets)
+{
+    if (facelets.size() != 54)
+        return StateStickerCount;
+    const ValidatorTables &t = tables();
+    uint8_t face[54];
+    int count[6] = {0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < 54; ++i)
+    {
+        int f = t.faceOf[(uint8_t)facelets[i]];
+        if (f < 0)
+            return StateStickerCount;
+        face[i] = (uint8_t)f;
+        ++count[f];
+    }
+    for (int f = 0; f < 6; ++f)
+        if (count[f] != 9)
+            return StateStickerCount;
+    for (int k = 0; k < 6; ++k)
+        if (facelets[k * 9 + 4] != kFaceletLetters[k])
+            return StateCenters;
+
+    // 每个槽位的颜色组合查表得到字节取值
+    CubieState s = solvedCubieState();
+    bool badEdge = false, badCorner = false;
+    for (int byte = 0; byte < 32; ++byte)
+    {
+        int n = t.faceletCount[byte];
+        if (n < 2)
+            continue;
+        int key = 0;
+        for (int k = n - 1; k >= 0; --k)
+            key = key * 6 + face[t.facelets[byte][k]];
+        uint8_t v = t.valueOf[byte][key];
+        if (v == 0xFF)
+        {
+            (n == 3 ? badCorner : badEdge) = true;
+            continue;
+        }
+        s.b[byte] = v;
+    }
+    return check(s, badEdge, badCorner);
+}
+
+StateError validateState(const CubieState &state)
+{
+    for (int i = 0; i < 8; ++i)
+        if (state.b[CubieState::kCornerOffset + i] >= 24)
+            return StateCorners;
+    for (int i = 0; i < 12; ++i)
+        if ((state.b[CubieState::kEdgeOffset + i] & 15) >= 12 || state.b[CubieState::kEdgeOffset + i] >= 32)
+            return StateEdges;
+    return check(state, false, false);
+}
+
+const char *stateErrorMessage(StateError error)
+{
+    switch (error)
+    {
+    case StateOk:
+        return "valid";
+    case StateStickerCount:
+        return "not exactly 9 stickers of each colour";
+    case StateEdges:
+        return "not all 12 edges exist exactly once";
+    case StateFlip:
+        return "flip error: one edge has to be flipped";
+    case StateCorners:
+        return "not all 8 corners exist exactly once";
+    case StateTwist:
+        return "twist error: one corner has to be twisted";
+    case StateParity:
+        return "parity error: two pieces have to be exchanged";
+    case StateCenters:
+        return "centers are not in a reachable arrangement";
+    }
+    return "unknown error";
+}
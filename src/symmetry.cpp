@@ -0,0 +1,254 @@
+#include "symmetry.h"
+#include <cstring>
+
+namespace {
+
+// 坐标轴的 6 种排列及其奇偶性：对称 s = 排列 * 8 + 翻转位（第 a 位表示新坐标轴 a 取反）
+const int kAxisPerm[6][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+const int kAxisPermOdd[6] = {0, 1, 1, 0, 0, 1};
+
+// 新坐标的第 a 维取自旧坐标的第 perm[a] 维，翻转位为 1 时取 2 - c
+void mapPosition(int symmetry, const int c[3], int out[3])
+{
+    const int *perm = kAxisPerm[symmetry / 8];
+    for (int a = 0; a < 3; ++a)
+        out[a] = (symmetry >> a & 1) ? 2 - c[perm[a]] : c[perm[a]];
+}
+
+// Face 枚举恰好是 轴 * 2 + (是否在坐标 2 的一侧)：LEFT/RIGHT、DOWN/UP、BACK/FRONT
+int mapFace(int symmetry, int face)
+{
+    const int *perm = kAxisPerm[symmetry / 8];
+    int a = 0;
+    while (perm[a] != face / 2)
+        ++a;
+    return a * 2 + ((face & 1) ^ (symmetry >> a & 1));
+}
+
+// 字节 i 上可能出现的取值（角块 id + 朝向 * 8，中心块 id，棱块 id + 朝向 * 16）
+bool validValue(int byte, int v)
+{
+    if (byte < CubieState::kCenterOffset)
+        return v < 24;
+    if (byte < CubieState::kEdgeOffset)
+        return v < 6;
+    return (v & 15) < 12;
+}
+
+const int kTouched = 8;
+
+uint64_t splitmix64(uint64_t &x)
+{
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+struct SymmetryTables {
+    uint64_t zobrist[32][32];
+    // 共轭按输出字节排列：out.b[j] = value[s][j][in.b[src[s][j]]]（填充字节原样保留），
+    // 规范形逐字节比较时可以在第一个较大的字节处停下
+    uint8_t src[kSymmetryCount][32];
+    uint8_t value[kSymmetryCount][32][32];
+    uint8_t inverse[kSymmetryCount];
+    uint8_t move[kSymmetryCount][MoveCount];
+    // 每个转动改动的字节（与 cubieMoveView 相同）：外层转动为 4 角 4 棱，中层转动为 4 棱 4 中心，恰好都是 8 个
+    uint8_t touched[MoveCount][kTouched];
+
+    SymmetryTables()
+    {
+        uint64_t seed = 0x525542494B33445Aull;
+        for (int i = 0; i < 32; ++i)
+            for (int v = 0; v < 32; ++v)
+                zobrist[i][v] = splitmix64(seed);
+
+        for (int m = 0; m < MoveCount; ++m)
+        {
+            CubieMoveView view = cubieMoveView((MoveId)m);
+            memcpy(touched[m], view.touched, kTouched);
+        }
+
+        const CubieState solved = solvedCubieState();
+        for (int s = 0; s < kSymmetryCount; ++s)
+        {
+            for (int i = 0; i < 32; ++i)
+            {
+                src[s][i] = (uint8_t)i;
+                for (int v = 0; v < 32; ++v)
+                    value[s][i][v] = (uint8_t)v;
+            }
+            for (int x = 0; x < 3; ++x)
+                for (int y = 0; y < 3; ++y)
+                    for (int z = 0; z < 3; ++z)
+                    {
+                        int from = slotByte(x, y, z);
+                        if (from < 0)
+                            continue;
+                        int c[3] = {x, y, z}, q[3];
+                        mapPosition(s, c, q);
+                        int to = slotByte(q[0], q[1], q[2]);
+                        src[s][to] = (uint8_t)from;
+                        // 取值 v 的各贴纸经几何变换与重新涂色后，找出目标槽位上贴纸完全一致的取值
+                        for (int v = 0; v < 32; ++v)
+                        {
+                            if (!validValue(from, v))
+                                continue;
+                            CubieState a = solved;
+                            a.b[from] = (uint8_t)v;
+                            for (int w = 0; w < 32; ++w)
+                            {
+                                if (!validValue(to, w))
+                                    continue;
+                                CubieState b = solved;
+                                b.b[to] = (uint8_t)w;
+                                bool same = true;
+                                for (int f = 0; f < 6 && same; ++f)
+                                {
+                                    int home = stickerHome(a, x, y, z, (Face)f);
+                                    if (home >= 0)
+                                        same = stickerHome(b, q[0], q[1], q[2], (Face)mapFace(s, f)) == mapFace(s, home);
+                                }
+                                if (same)
+                                {
+                                    value[s][to][v] = (uint8_t)w;
+                                    break;
+                                }
+                            }
+                        }
+                    }
+        }
+
+        // 逆对称：两次几何变换后 8 个角位置都回到原处
+        for (int s = 0; s < kSymmetryCount; ++s)
+            for (int t = 0; t < kSymmetryCount; ++t)
+            {
+                bool identity = true;
+                for (int k = 0; k < 8 && identity; ++k)
+                {
+                    int c[3] = {k & 1 ? 2 : 0, k & 2 ? 2 : 0, k & 4 ? 2 : 0}, m[3], back[3];
+                    mapPosition(s, c, m);
+                    mapPosition(t, m, back);
+                    identity = back[0] == c[0] && back[1] == c[1] && back[2] == c[2];
+                }
+                if (identity)
+                    inverse[s] = (uint8_t)t;
+            }
+
+        // 转动的像：共轭后的单步转动状态仍是某个单步转动
+        CubieState moved[MoveCount];
+        for (int m = 0; m < MoveCount; ++m)
+        {
+            moved[m] = solved;
+            applyMove(moved[m], (MoveId)m);
+        }
+        for (int s = 0; s < kSymmetryCount; ++s)
+            for (int m = 0; m < MoveCount; ++m)
+            {
+                CubieState c = conjugate(moved[m], s);
+                move[s][m] = (uint8_t)m;
+                for (int k = 0; k < MoveCount; ++k)
+                    if (moved[k] == c)
+                        move[s][m] = (uint8_t)k;
+            }
+    }
+
+    CubieState conjugate(const CubieState &state, int s) const
+    {
+        CubieState out;
+        for (int j = 0; j < 32; ++j)
+            out.b[j] = value[s][j][state.b[src[s][j]] & 31];
+        return out;
+    }
+};
+
+const SymmetryTables &tables()
+{
+    static const SymmetryTables t;
+    return t;
+}
+
+} // namespace
+
+uint64_t zobristHash(const CubieState &state)
+{
+    const SymmetryTables &t = tables();
+    uint64_t h = 0;
+    for (int i = 0; i < 32; ++i)
+        h ^= t.zobrist[i][state.b[i] & 31];
+    return h;
+}
+
+void applyMove(CubieState &state, MoveId move, uint64_t &hash)
+{
+    const SymmetryTables &t = tables();
+    const uint8_t *idx = t.touched[move];
+    uint64_t h = hash;
+    for (int k = 0; k < kTouched; ++k)
+        h ^= t.zobrist[idx[k]][state.b[idx[k]]];
+    applyMove(state, move);
+    for (int k = 0; k < kTouched; ++k)
+        h ^= t.zobrist[idx[k]][state.b[idx[k]]];
+    hash = h;
+}
+
+CubieState conjugateState(const CubieState &state, int symmetry)
+{
+    return tables().conjugate(state, symmetry);
+}
+
+MoveId conjugateMove(MoveId move, int symmetry)
+{
+    return static_cast<MoveId>(tables().move[symmetry][move]);
+}
+
+void conjugateMoves(std::vector<MoveId> &moves, int symmetry)
+{
+    const uint8_t *map = tables().move[symmetry];
+    for (MoveId &m : moves)
+        m = static_cast<MoveId>(map[m]);
+}
+
+int inverseSymmetry(int symmetry)
+{
+    return tables().inverse[symmetry];
+}
+
+bool isMirrorSymmetry(int symmetry)
+{
+    int flips = (symmetry & 1) + (symmetry >> 1 & 1) + (symmetry >> 2 & 1);
+    return (kAxisPermOdd[symmetry / 8] + flips) % 2 == 1;
+}
+
+CubieState canonicalState(const CubieState &state, int *symmetry)
+{
+    const SymmetryTables &t = tables();
+    CubieState best = state;
+    int bestSymmetry = 0;
+    for (int s = 1; s < kSymmetryCount; ++s)
+    {
+        // 与当前最小者逐字节比较，第一个不等的字节较大就放弃这个对称
+        CubieState c;
+        int order = 0;
+        int j = 0;
+        for (; j < 32; ++j)
+        {
+            uint8_t v = t.value[s][j][state.b[t.src[s][j]] & 31];
+            if (order == 0 && v != best.b[j])
+            {
+                if (v > best.b[j])
+                    break;
+                order = -1;
+            }
+            c.b[j] = v;
+        }
+        if (order < 0)
+        {
+            best = c;
+            bestSymmetry = s;
+        }
+    }
+    if (symmetry)
+        *symmetry = bestSymmetry;
+    return best;
+}
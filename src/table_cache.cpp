@@ -0,0 +1,175 @@
+#include "table_cache.h"
+#include "min2phase/min2phase.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// 表文件是 min2phase::writeFile 的原始输出（loadFile 只能读整个文件），
+// 版本与校验信息放在同名的 .meta 旁车文件里
+const char kMagic[8] = {'R', 'B', 'K', 'T', 'B', 'L', '0', '1'};
+const uint32_t kVersion = 1;
+
+struct MetaHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t size;
+    uint64_t checksum;
+};
+
+std::atomic<bool> ready{false};
+std::once_flag once;
+
+// 按 8 字节一组的 FNV-1a 变体，足以发现截断和损坏
+uint64_t checksum(const uint8_t *p, size_t n)
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        h = (h ^ w) * 0x100000001b3ull;
+    }
+    for (; i < n; ++i)
+        h = (h ^ p[i]) * 0x100000001b3ull;
+    return h;
+}
+
+// mmap 整个文件计算校验和。映射只用于校验，算完立即解除；表数据随后由 min2phase::loadFile 再读一遍
+// （它只接受路径，无法直接用这块内存）。这里不用 MADV_SEQUENTIAL：那会让内核读完就把页面降级回收，
+// 用 MADV_WILLNEED 让页面留在页缓存里，第二遍读取不再走磁盘
+bool checksumFile(const std::string &path, uint64_t &size, uint64_t &sum)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return false;
+    }
+    size = (uint64_t)st.st_size;
+    void *map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+    madvise(map, size, MADV_WILLNEED);
+    sum = checksum(static_cast<const uint8_t *>(map), size);
+    munmap(map, size);
+    return true;
+}
+
+bool readMeta(const std::string &path, MetaHeader &meta)
+{
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+    bool ok = fread(&meta, sizeof(meta), 1, f) == 1;
+    fclose(f);
+    return ok && memcmp(meta.magic, kMagic, sizeof(kMagic)) == 0 && meta.version == kVersion;
+}
+
+bool tryLoad(const std::string &path)
+{
+    MetaHeader meta;
+    if (!readMeta(path + ".meta", meta))
+        return false;
+    uint64_t size, sum;
+    if (!checksumFile(path, size, sum) || size != meta.size || sum != meta.checksum)
+    {
+        std::cout << "[TableCache] " << path << " is stale or corrupt, rebuilding" << std::endl;
+        return false;
+    }
+    // 校验刚把整个文件读进页缓存，这次读取是内存拷贝
+    return min2phase::loadFile(path);
+}
+
+void mkdirs(const std::string &dir)
+{
+    for (size_t i = 1; i <= dir.size(); ++i)
+        if (i == dir.size() || dir[i] == '/')
+            mkdir(dir.substr(0, i).c_str(), 0755);
+}
+
+// 先写临时文件再 rename，其它进程只会看到完整的表文件
+void store(const std::string &path)
+{
+    size_t slash = path.rfind('/');
+    if (slash != std::string::npos)
+        mkdirs(path.substr(0, slash));
+    std::string tmp = path + ".tmp." + std::to_string(getpid());
+    MetaHeader meta = {};
+    memcpy(meta.magic, kMagic, sizeof(kMagic));
+    meta.version = kVersion;
+    if (!min2phase::writeFile(tmp) || !checksumFile(tmp, meta.size, meta.checksum))
+    {
+        unlink(tmp.c_str());
+        std::cout << "[TableCache] failed to write " << path << std::endl;
+        return;
+    }
+    std::string metaTmp = tmp + ".meta";
+    FILE *f = fopen(metaTmp.c_str(), "wb");
+    bool ok = f && fwrite(&meta, sizeof(meta), 1, f) == 1;
+    if (f)
+        ok = fclose(f) == 0 && ok;
+    if (ok && rename(tmp.c_str(), path.c_str()) == 0 && rename(metaTmp.c_str(), (path + ".meta").c_str()) == 0)
+        return;
+    unlink(tmp.c_str());
+    unlink(metaTmp.c_str());
+    std::cout << "[TableCache] failed to write " << path << std::endl;
+}
+
+} // namespace
+
+std::string TableCache::cachePath()
+{
+    if (const char *p = getenv("RUBIK_TABLE_CACHE"))
+        return p;
+    return cacheDir() + "/min2phase-v" + std::to_string(kVersion) + ".tables";
+}
+
+std::string TableCache::cacheDir()
+{
+    std::string dir;
+    if (const char *xdg = getenv("XDG_CACHE_HOME"))
+        dir = xdg;
+    else if (const char *home = getenv("HOME"))
+        dir = std::string(home) + "/.cache";
+    else
+        dir = "/tmp";
+    return dir + "/rubik3d";
+}
+
+void TableCache::ensureReady()
+{
+    std::call_once(once, [] {
+        std::string path = cachePath();
+        if (tryLoad(path))
+        {
+            std::cout << "[TableCache] loaded " << path << std::endl;
+        }
+        else
+        {
+            min2phase::init();
+            store(path);
+        }
+        ready.store(true, std::memory_order_release);
+    });
+}
+
+bool TableCache::isReady()
+{
+    return ready.load(std::memory_order_acquire);
+}
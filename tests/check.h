@@ -0,0 +1,28 @@
+#pragma once
+// 测试用的最小断言：失败时打印位置并计数，main 最后返回 checkFailures() != 0
+#include <cstdio>
+
+inline int &checkFailureCount()
+{
+    static int count = 0;
+    return count;
+}
+
+inline int checkFailures()
+{
+    if (checkFailureCount() == 0)
+        printf("ok\n");
+    else
+        printf("%d check(s) failed\n", checkFailureCount());
+    return checkFailureCount();
+}
+
+#define CHECK(cond)                                                                  \
+    do                                                                               \
+    {                                                                                \
+        if (!(cond))                                                                 \
+        {                                                                            \
+            if (checkFailureCount()++ < 20)                                          \
+                fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        }                                                                            \
+    } while (0)
@@ -0,0 +1,69 @@
+// CubeN 测试：
+//   - CubeN<3> 与 Cube 在随机转动序列（含中层）下逐个贴纸一致
+//   - 其它阶数：同一层转四次、正反各转一次都回到原状态
+#include "check.h"
+#include "cube.h"
+#include "cube_n.h"
+#include "scrambler.h"
+
+namespace {
+
+bool sameStickers(const Cube &a, const CubeN<3> &b)
+{
+    for (int x = 0; x < 3; ++x)
+        for (int y = 0; y < 3; ++y)
+            for (int z = 0; z < 3; ++z)
+                for (int f = 0; f < 6; ++f)
+                    if (a.stickerHome(x, y, z, (Face)f) != b.stickerHome(x, y, z, (Face)f))
+                        return false;
+    return true;
+}
+
+template <int N>
+void checkInverses(ScrambleRng &rng)
+{
+    CubeN<N> cube;
+    for (int i = 0; i < 200; ++i)
+        cube.rotateLayer((Axis)rng.below(3), (int)rng.below(N), rng.below(2) != 0);
+    for (int axis = 0; axis < 3; ++axis)
+        for (int layer = 0; layer < N; ++layer)
+        {
+            CubeN<N> turned = cube;
+            for (int k = 0; k < 4; ++k)
+                turned.rotateLayer((Axis)axis, layer, true);
+            CHECK(turned == cube);
+            turned.rotateLayer((Axis)axis, layer, true);
+            CHECK(turned != cube);
+            turned.rotateLayer((Axis)axis, layer, false);
+            CHECK(turned == cube);
+        }
+    CHECK(CubeN<N>().isSolved());
+    CHECK(!cube.isSolved());
+}
+
+} // namespace
+
+int main()
+{
+    ScrambleRng rng(17);
+    for (int run = 0; run < 100; ++run)
+    {
+        Cube cube;
+        CubeN<3> cubeN;
+        for (int i = 0; i < 60; ++i)
+        {
+            Axis axis = (Axis)rng.below(3);
+            int layer = (int)rng.below(3);
+            bool clockwise = rng.below(2) != 0;
+            cube.rotateLayer(axis, layer, clockwise);
+            cubeN.rotateLayer(axis, layer, clockwise);
+            CHECK(sameStickers(cube, cubeN));
+        }
+        CHECK(cube.isSolved() == cubeN.isSolved());
+    }
+    checkInverses<2>(rng);
+    checkInverses<4>(rng);
+    checkInverses<5>(rng);
+    checkInverses<17>(rng);
+    return checkFailures();
+}
@@ -0,0 +1,144 @@
+// 转动日志测试：
+//   - 任意位置的 stateAt（跨检查点）与从头重放一致
+//   - read 的起点不在检查点上、跨过检查点、越过结尾
+//   - 在任意字节处截断的文件（录制中途）仍能打开，只报告完整的转动，最后一条就是最后写完的转动
+#include "check.h"
+#include "move_log.h"
+#include "moves.h"
+#include "scrambler.h"
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+const uint32_t kInterval = 8;
+const size_t kMoves = 100;
+const size_t kCheckpointSize = 41;  // 见 move_log.h 的文件布局
+
+struct Recorded {
+    MoveId move;
+    CommandSource source;
+    double seconds;
+};
+
+size_t fileSize(const std::string &path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+std::vector<uint8_t> readAll(const std::string &path)
+{
+    std::vector<uint8_t> bytes(fileSize(path));
+    FILE *f = fopen(path.c_str(), "rb");
+    if (f)
+    {
+        if (fread(bytes.data(), 1, bytes.size(), f) != bytes.size())
+            bytes.clear();
+        fclose(f);
+    }
+    return bytes;
+}
+
+void writePrefix(const std::string &path, const std::vector<uint8_t> &bytes, size_t length)
+{
+    FILE *f = fopen(path.c_str(), "wb");
+    fwrite(bytes.data(), 1, length, f);
+    fclose(f);
+}
+
+bool sameEntry(const MoveLogEntry &e, const Recorded &r)
+{
+    return e.move == r.move && e.source == r.source && e.timeCs == (uint32_t)(r.seconds * 100.0 + 0.5);
+}
+
+} // namespace
+
+int main()
+{
+    std::string path = "move_log_test." + std::to_string(getpid()) + ".log";
+    std::string cut = path + ".cut";
+    ScrambleRng rng(18);
+
+    // 从一个随机状态开始录制；时间间隔里夹几次超过 127 cs 的停顿，覆盖多字节的时间差
+    CubieState initial = randomCubieState(rng);
+    std::vector<Recorded> log;
+    std::vector<CubieState> states(1, initial);
+    std::vector<size_t> moveEnd(1, 0);  // 第 k 个转动记录结束处的文件偏移（不含其后的检查点）
+    MoveLogWriter writer;
+    CHECK(writer.open(path, initial, kInterval));
+    moveEnd[0] = fileSize(path);
+    double seconds = 0.0;
+    for (size_t i = 0; i < kMoves; ++i)
+    {
+        seconds += i % 17 == 16 ? 5.0 : 0.25;
+        Recorded r = {(MoveId)rng.below(MoveCount), (CommandSource)rng.below(SourceCount), seconds};
+        CubieState after = states.back();
+        applyMove(after, r.move);
+        writer.append(r.move, r.source, r.seconds, after);
+        writer.flush();
+        log.push_back(r);
+        states.push_back(after);
+        moveEnd.push_back(fileSize(path) - ((i + 1) % kInterval == 0 ? kCheckpointSize : 0));
+    }
+    writer.close();
+
+    {
+        MoveLogReader reader;
+        CHECK(reader.open(path));
+        CHECK(reader.size() == kMoves);
+        CHECK(reader.interval() == kInterval);
+
+        // stateAt：检查点前后、检查点本身、越界
+        for (size_t i = 0; i <= kMoves; ++i)
+            CHECK(reader.stateAt(i) == states[i]);
+        CHECK(reader.stateAt(kMoves + 10) == states[kMoves]);
+
+        // read：起点不在检查点上，且跨过下一个检查点
+        std::vector<MoveLogEntry> out;
+        CHECK(reader.read(13, 20, out) == 20);
+        for (size_t i = 0; i < out.size(); ++i)
+            CHECK(sameEntry(out[i], log[13 + i]));
+        // 起点恰好在检查点上
+        CHECK(reader.read(16, 3, out) == 3);
+        CHECK(sameEntry(out[0], log[16]));
+        // 越过结尾只读到剩下的部分
+        CHECK(reader.read(kMoves - 5, 20, out) == 5);
+        CHECK(sameEntry(out.back(), log.back()));
+        CHECK(reader.read(kMoves, 1, out) == 0);
+        CHECK(out.empty());
+    }
+
+    // 在每个字节处截断：完整记录数与写入时的偏移一致，状态与最后一条记录都对得上
+    std::vector<uint8_t> bytes = readAll(path);
+    CHECK(bytes.size() == fileSize(path));
+    for (size_t length = moveEnd[0]; length <= bytes.size(); ++length)
+    {
+        size_t complete = 0;
+        while (complete < kMoves && moveEnd[complete + 1] <= length)
+            ++complete;
+        writePrefix(cut, bytes, length);
+        MoveLogReader reader;
+        CHECK(reader.open(cut));
+        CHECK(reader.size() == complete);
+        CHECK(reader.stateAt(complete) == states[complete]);
+        std::vector<MoveLogEntry> out;
+        if (complete > 0)
+        {
+            CHECK(reader.read(complete - 1, 10, out) == 1);
+            CHECK(!out.empty() && sameEntry(out[0], log[complete - 1]));
+        }
+    }
+    // 连初始检查点都不完整的文件打不开
+    writePrefix(cut, bytes, moveEnd[0] - 1);
+    {
+        MoveLogReader reader;
+        CHECK(!reader.open(cut));
+    }
+
+    unlink(path.c_str());
+    unlink(cut.c_str());
+    return checkFailures();
+}
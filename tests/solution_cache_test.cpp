@@ -0,0 +1,193 @@
+// 解缓存测试（RUBIK_SOLUTION_CACHE 指向当前目录下的临时文件）：
+//   - 一个状态存入后，它的 48 个对称副本（含镜像）与 24 种整体转动后的副本都能命中，返回的解复原该副本
+//   - 来源更好的记录取代更差的，更差的不会反过来覆盖；重新扫描文件也得到同样的结果
+//   - 写入中断留在文件结尾的半条记录在打开时被截掉，之后追加的记录能被新进程扫描到
+// 缓存只在第一次使用时打开、扫描文件，所以“另一个进程”的部分重新启动本程序（--writer / --reader）完成
+#include "check.h"
+#include "moves.h"
+#include "scrambler.h"
+#include "solution_cache.h"
+#include "symmetry.h"
+#include <cstdlib>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct Case {
+    CubieState state;
+    std::vector<MoveId> solution;
+};
+
+// 只用外层转动打乱（中心不动），解为打乱取逆
+Case makeCase(ScrambleRng &rng, int length)
+{
+    Case c;
+    std::vector<MoveId> scramble;
+    for (int i = 0; i < length; ++i)
+        scramble.push_back((MoveId)rng.below(MoveFaceCount));
+    c.state = solvedCubieState();
+    applySequence(c.state, scramble.data(), scramble.size());
+    c.solution = scramble;
+    invertMoves(c.solution);
+    return c;
+}
+
+// moves 把 state 变成 target（整体转动后的副本复原后中心仍在转动后的位置）
+bool reaches(CubieState state, const std::vector<MoveId> &moves, const CubieState &target)
+{
+    applySequence(state, moves.data(), moves.size());
+    return state == target;
+}
+
+size_t fileSize(const std::string &path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+// 以 mode 为参数重新运行本程序（环境变量随之继承），成功返回 true
+bool runSelf(const char *self, const char *mode)
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        execl(self, self, mode, (char *)nullptr);
+        _exit(127);
+    }
+    int status = 0;
+    return pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    // 各进程用同一个种子得到同样的三个状态
+    ScrambleRng rng(23);
+    Case a = makeCase(rng, 12);
+    Case b = makeCase(rng, 14);
+    Case c = makeCase(rng, 16);
+
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--writer")
+    {
+        SolutionCache::insert(a.state, a.solution, QualityTwoPhase);
+        SolutionCache::insert(b.state, b.solution, QualityPortfolio);
+        return 0;
+    }
+    if (mode == "--reader")
+    {
+        // 截断后追加的 c 能扫描到，a 取来源最好、其次最短的记录
+        std::vector<MoveId> found;
+        SolutionQuality q = QualityOptimal;
+        CHECK(SolutionCache::lookup(c.state, found, &q));
+        CHECK(q == QualityTwoPhase && reaches(c.state, found, solvedCubieState()));
+        CHECK(SolutionCache::lookup(a.state, found, &q));
+        CHECK(q == QualityOptimal && found.size() == a.solution.size());
+        CHECK(SolutionCache::lookup(b.state, found, &q));
+        CHECK(q == QualityPortfolio);
+        return checkFailureCount() != 0;
+    }
+
+    std::string path = "solution_cache_test." + std::to_string(getpid()) + ".bin";
+    unlink(path.c_str());
+    setenv("RUBIK_SOLUTION_CACHE", path.c_str(), 1);
+    CHECK(SolutionCache::cachePath() == path);
+
+    // 另一个进程写入 a、b
+    CHECK(runSelf(argv[0], "--writer"));
+    size_t written = fileSize(path);
+    CHECK(written > 16);
+
+    // 模拟写入中断：结尾追加半条记录（声明 10 步，只写了一部分）
+    {
+        FILE *f = fopen(path.c_str(), "ab");
+        const uint8_t torn[] = {10, QualityOptimal, 1, 2, 3};
+        fwrite(torn, 1, sizeof(torn), f);
+        fclose(f);
+    }
+    CHECK(fileSize(path) == written + 5);
+
+    // 本进程第一次使用时扫描文件：两条记录都在，半条记录被截掉
+    std::vector<MoveId> moves;
+    SolutionQuality quality = QualityOptimal;
+    CHECK(SolutionCache::lookup(a.state, moves, &quality));
+    CHECK(quality == QualityTwoPhase);
+    CHECK(reaches(a.state, moves, solvedCubieState()));
+    CHECK(fileSize(path) == written);
+    CHECK(SolutionCache::lookup(b.state, moves, &quality));
+    CHECK(quality == QualityPortfolio);
+
+    // 对称副本：conjugateState 覆盖 24 种旋转与各自的镜像
+    for (int sym = 0; sym < kSymmetryCount; ++sym)
+    {
+        CubieState copy = conjugateState(a.state, sym);
+        moves.clear();
+        CHECK(SolutionCache::lookup(copy, moves));
+        CHECK(reaches(copy, moves, solvedCubieState()));
+    }
+    // 整体转动后的副本：中心不在原位，解复原后中心仍留在转动后的位置
+    const std::vector<std::vector<MoveId>> &rotations = cubeRotations();
+    CHECK(rotations.size() == 24);
+    for (const std::vector<MoveId> &rotation : rotations)
+    {
+        CubieState copy = b.state;
+        applySequence(copy, rotation.data(), rotation.size());
+        CubieState target = solvedCubieState();
+        applySequence(target, rotation.data(), rotation.size());
+        moves.clear();
+        CHECK(SolutionCache::lookup(copy, moves));
+        CHECK(reaches(copy, moves, target));
+        CHECK(moves.size() == b.solution.size());
+        for (MoveId m : moves)
+            CHECK(m < MoveFaceCount);
+    }
+
+    // 更好的来源取代更差的，哪怕更长（从一个镜像副本存入，键相同）
+    std::vector<MoveId> longer = a.solution;
+    longer.push_back(MoveR);
+    longer.push_back(MoveRPrime);
+    CHECK(SolutionCache::lookup(a.state, moves));
+    int mirror = 1;
+    while (mirror < kSymmetryCount && !isMirrorSymmetry(mirror))
+        ++mirror;
+    CHECK(mirror < kSymmetryCount);
+    CubieState mirrored = conjugateState(a.state, mirror);
+    std::vector<MoveId> mirroredLonger = longer;
+    conjugateMoves(mirroredLonger, mirror);
+    SolutionCache::insert(mirrored, mirroredLonger, QualityOptimal);
+    CHECK(SolutionCache::lookup(a.state, moves, &quality));
+    CHECK(quality == QualityOptimal);
+    CHECK(moves.size() == longer.size());
+    CHECK(reaches(a.state, moves, solvedCubieState()));
+    // 更差的来源不会覆盖，哪怕更短
+    SolutionCache::insert(a.state, a.solution, QualityPortfolio);
+    CHECK(SolutionCache::lookup(a.state, moves, &quality));
+    CHECK(quality == QualityOptimal);
+    // 同一来源，更短的取代更长的
+    SolutionCache::insert(a.state, a.solution, QualityOptimal);
+    CHECK(SolutionCache::lookup(a.state, moves, &quality));
+    CHECK(quality == QualityOptimal && moves.size() == a.solution.size());
+    // 不能复原的解不记录
+    std::vector<MoveId> wrong = c.solution;
+    wrong.pop_back();
+    SolutionCache::insert(c.state, wrong, QualityOptimal);
+    CHECK(!SolutionCache::lookup(c.state, moves));
+    SolutionCache::insert(c.state, c.solution, QualityTwoPhase);
+
+    // 新进程重新扫描整个文件
+    CHECK(runSelf(argv[0], "--reader"));
+
+    // 关闭后不命中
+    SolutionCache::setEnabled(false);
+    CHECK(!SolutionCache::lookup(a.state, moves));
+    SolutionCache::setEnabled(true);
+
+    unlink(path.c_str());
+    return checkFailures();
+}
@@ -0,0 +1,104 @@
+// 状态检查测试：
+//   - 随机合法状态（含中层转动移动过中心的）两个入口都判为合法
+//   - 从复原状态各改一处，得到 min2phase 的错误码 1-6 与 9
+#include "check.h"
+#include "cube.h"
+#include "moves.h"
+#include "scrambler.h"
+#include "solver.h"
+#include "state_validator.h"
+#include <string>
+#include <utility>
+
+namespace {
+
+// facelet 串的下标（URFDLB 各 9 格，每面从左上角按行编号）
+const int U = 0, R = 9, F = 18, D = 27;
+
+std::string solvedFacelets()
+{
+    return Solver::encodeFacelets(Cube());
+}
+
+std::string swapped(std::string s, std::initializer_list<std::pair<int, int>> swaps)
+{
+    for (const auto &p : swaps)
+        std::swap(s[p.first], s[p.second]);
+    return s;
+}
+
+CubieState solvedWith(int byte, uint8_t value)
+{
+    CubieState s = solvedCubieState();
+    s.b[byte] = value;
+    return s;
+}
+
+} // namespace
+
+int main()
+{
+    ScrambleRng rng(24);
+
+    // 合法状态
+    CHECK(validateFacelets(solvedFacelets()) == StateOk);
+    CHECK(validateState(solvedCubieState()) == StateOk);
+    for (int run = 0; run < 200; ++run)
+    {
+        Cube cube;
+        cube.setState(randomCubieState(rng));
+        CHECK(validateState(cube.state()) == StateOk);
+        CHECK(validateFacelets(Solver::encodeFacelets(cube)) == StateOk);
+        // 中层转动会移动中心，小块状态仍然合法
+        CubieState s = cube.state();
+        for (int k = 0; k < 20; ++k)
+            applyMove(s, (MoveId)rng.below(MoveCount));
+        CHECK(validateState(s) == StateOk);
+    }
+
+    // 1：长度、字母、颜色个数
+    std::string solved = solvedFacelets();
+    CHECK(validateFacelets(solved.substr(0, 53)) == StateStickerCount);
+    CHECK(validateFacelets(solved + "U") == StateStickerCount);
+    std::string bad = solved;
+    bad[U + 0] = 'X';
+    CHECK(validateFacelets(bad) == StateStickerCount);
+    bad = solved;
+    bad[R + 0] = 'U';
+    CHECK(validateFacelets(bad) == StateStickerCount);
+
+    // 9：颜色个数对，但中心不在原位
+    CHECK(validateFacelets(swapped(solved, {{U + 4, D + 4}})) == StateCenters);
+
+    // 2：UF 棱块的 U 面贴纸与 DF 棱块的 F 面贴纸互换，两个棱块的颜色组合都不存在
+    CHECK(validateFacelets(swapped(solved, {{U + 7, F + 7}})) == StateEdges);
+    // 3：只翻转 UF 棱块
+    CHECK(validateFacelets(swapped(solved, {{U + 7, F + 1}})) == StateFlip);
+    // 4：URF 角块的 U 面贴纸与 UFL 角块的 F 面贴纸互换
+    CHECK(validateFacelets(swapped(solved, {{U + 8, F + 0}})) == StateCorners);
+    // 5：只拧 URF 角块（三张贴纸轮换）
+    CHECK(validateFacelets(swapped(solved, {{U + 8, R + 0}, {U + 8, F + 2}})) == StateTwist);
+    // 6：只交换 UF 与 UR 两个棱块
+    CHECK(validateFacelets(swapped(solved, {{U + 7, U + 5}, {F + 1, R + 1}})) == StateParity);
+
+    // 小块状态的同类错误
+    const int c0 = CubieState::kCornerOffset, e0 = CubieState::kEdgeOffset, m0 = CubieState::kCenterOffset;
+    CHECK(validateState(solvedWith(c0, 24)) == StateCorners);
+    CHECK(validateState(solvedWith(c0, 1)) == StateCorners);     // 角块 1 出现两次
+    CHECK(validateState(solvedWith(e0, 12)) == StateEdges);
+    CHECK(validateState(solvedWith(e0, 32)) == StateEdges);
+    CHECK(validateState(solvedWith(e0, 1)) == StateEdges);       // 棱块 1 出现两次
+    CHECK(validateState(solvedWith(e0, 0 + 16)) == StateFlip);
+    CHECK(validateState(solvedWith(c0, 0 + 8)) == StateTwist);
+    CubieState s = solvedCubieState();
+    std::swap(s.b[c0], s.b[c0 + 1]);
+    CHECK(validateState(s) == StateParity);
+    s = solvedCubieState();
+    std::swap(s.b[m0], s.b[m0 + 1]);
+    CHECK(validateState(s) == StateCenters);
+    // 错误码的说明都不为空
+    for (StateError e : {StateOk, StateStickerCount, StateEdges, StateFlip, StateCorners, StateTwist, StateParity,
+                         StateCenters})
+        CHECK(stateErrorMessage(e)[0] != '\0');
+    return checkFailures();
+}
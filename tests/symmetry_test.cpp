@@ -0,0 +1,106 @@
+// 对称与哈希测试（SolutionCache 的键依赖这些性质）：
+//   - 增量 Zobrist 哈希与全量重算一致，Cube::hash() 跟随转动与 setState
+//   - 共轭是同态：conj(s·m) = conj(s)·conj(m)，且逆对称把共轭还原
+//   - 规范形在 48 个对称下不变，返回的对称确实把状态变到规范形
+//   - 规范形的解按逆对称换算回来后能复原原状态
+#include "check.h"
+#include "cube.h"
+#include "moves.h"
+#include "scrambler.h"
+#include "symmetry.h"
+#include <vector>
+
+namespace {
+
+std::vector<MoveId> randomMoves(ScrambleRng &rng, int count)
+{
+    std::vector<MoveId> moves;
+    for (int i = 0; i < count; ++i)
+        moves.push_back((MoveId)rng.below(MoveCount));
+    return moves;
+}
+
+bool solves(CubieState state, const std::vector<MoveId> &moves)
+{
+    applySequence(state, moves.data(), moves.size());
+    return state == solvedCubieState();
+}
+
+} // namespace
+
+int main()
+{
+    ScrambleRng rng(22);
+
+    // 增量哈希
+    for (int run = 0; run < 200; ++run)
+    {
+        CubieState s = solvedCubieState();
+        uint64_t hash = zobristHash(s);
+        Cube cube;
+        for (MoveId m : randomMoves(rng, 40))
+        {
+            applyMove(s, m, hash);
+            cube.applyMove(m);
+            CHECK(hash == zobristHash(s));
+            CHECK(cube.hash() == hash);
+        }
+        Cube copy;
+        copy.setState(s);
+        CHECK(copy.hash() == hash && copy == cube);
+    }
+
+    for (int sym = 0; sym < kSymmetryCount; ++sym)
+    {
+        int inv = inverseSymmetry(sym);
+        CHECK(inv >= 0 && inv < kSymmetryCount);
+        CHECK(inverseSymmetry(inv) == sym);
+        CHECK(isMirrorSymmetry(inv) == isMirrorSymmetry(sym));
+        CHECK(conjugateState(solvedCubieState(), sym) == solvedCubieState());
+        for (int m = 0; m < MoveCount; ++m)
+            CHECK(conjugateMove(conjugateMove((MoveId)m, sym), inv) == (MoveId)m);
+    }
+
+    for (int run = 0; run < 50; ++run)
+    {
+        std::vector<MoveId> scramble = randomMoves(rng, 25);
+        CubieState s = solvedCubieState();
+        applySequence(s, scramble.data(), scramble.size());
+        // 复原 s 的序列：打乱取逆
+        std::vector<MoveId> solution = scramble;
+        invertMoves(solution);
+
+        int canonicalSym = -1;
+        CubieState canonical = canonicalState(s, &canonicalSym);
+        CHECK(canonicalSym >= 0 && canonicalSym < kSymmetryCount);
+        CHECK(conjugateState(s, canonicalSym) == canonical);
+
+        for (int sym = 0; sym < kSymmetryCount; ++sym)
+        {
+            CubieState c = conjugateState(s, sym);
+            CHECK(conjugateState(c, inverseSymmetry(sym)) == s);
+            // 同态：逐步比较
+            MoveId m = (MoveId)rng.below(MoveCount);
+            CubieState after = s;
+            applyMove(after, m);
+            CubieState lhs = conjugateState(after, sym);
+            CubieState rhs = c;
+            applyMove(rhs, conjugateMove(m, sym));
+            CHECK(lhs == rhs);
+            // 解的共轭复原共轭后的状态
+            std::vector<MoveId> conjugated = solution;
+            conjugateMoves(conjugated, sym);
+            CHECK(solves(c, conjugated));
+            // 规范形不变
+            CHECK(canonicalState(c) == canonical);
+        }
+
+        // 规范形的解换算回原状态
+        std::vector<MoveId> canonicalSolution = solution;
+        conjugateMoves(canonicalSolution, canonicalSym);
+        CHECK(solves(canonical, canonicalSolution));
+        conjugateMoves(canonicalSolution, inverseSymmetry(canonicalSym));
+        CHECK(solves(s, canonicalSolution));
+    }
+    return checkFailures();
+}
@@ -0,0 +1,283 @@
+// rubik_batch：无窗口批量求解
+// 从标准输入或文件逐行读取 54 字符的 facelet 串（URFDLB 顺序），在线程池上并发求解，
+// 按输入顺序把解写到标准输出；结束时在标准错误输出吞吐、延迟分位数和平均步数
+// --random N 时不读输入，改为用 --seed 生成 N 个均匀随机状态（同一种子结果相同）；
+// --scramble 时输出解的逆，即从复原状态到达该状态的打乱序列
+// --optimal 时改用 IDA* 求最优解（每个状态单线程，多个状态并发），超过 --budget 秒（默认 60）的状态记为失败（"Error 8"）
+// --portfolio N 时每个状态做 N 个变体的组合求解，--budget 为每个状态的墙钟预算（默认 0.5 秒）
+// 输入先经 validateFacelets 检查，不可能复原的状态直接输出与 min2phase 相同的 "Error N"，不占用求解时间
+//
+// 用法：rubik_batch [-j 线程数] [--max-depth 21] [--probe 1000000] [--optimal | --portfolio N] [--budget S]
+//                   [--random N [--seed S]] [--scramble] [输入文件]
+#include "optimal_solver.h"
+#include "scrambler.h"
+#include "solver.h"
+#include "state_validator.h"
+#include "table_cache.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    std::string solution;  // min2phase 的原始输出
+    size_t moves;          // 解的步数（HTM），失败时为 0
+    bool ok;
+    double latencyUs;
+};
+
+struct Options {
+    size_t threads = 0;
+    int maxDepth = 21;
+    int probeMax = 1000000;
+    const char *input = nullptr;
+    size_t random = 0;     // >0 时生成随机状态代替输入
+    uint64_t seed = 1;
+    bool scramble = false; // 输出打乱序列而不是解
+    bool optimal = false;  // 用最优求解器代替 min2phase
+    size_t portfolio = 0;  // >0 时做该数量变体的组合求解
+    double budget = 0.0;   // 每个状态的时间预算（秒），0 为默认值
+};
+
+void usage()
+{
+    std::cerr << "usage: rubik_batch [-j threads] [--max-depth N] [--probe N] [--optimal | --portfolio N] [--budget S]\n"
+                 "                   [--random N [--seed S]] [--scramble] [file]\n"
+                 "  reads one 54-char facelet string (URFDLB) per line from file or stdin,\n"
+                 "  writes one solution per line to stdout in input order\n"
+                 "  --random N   solve N uniformly random states drawn from --seed instead of reading input\n"
+                 "  --scramble   print the inverse of each solution (a scramble reaching that state)\n"
+                 "  --optimal    find optimal (HTM) solutions with IDA*, giving up on a state after --budget seconds\n"
+                 "  --portfolio N  solve N variants (orientations x inverse) of each state, keep the shortest\n";
+}
+
+bool parseArgs(int argc, char **argv, Options &opt)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(a, "-j") && hasValue)
+            opt.threads = (size_t)atoi(argv[++i]);
+        else if (!strcmp(a, "--max-depth") && hasValue)
+            opt.maxDepth = atoi(argv[++i]);
+        else if (!strcmp(a, "--probe") && hasValue)
+            opt.probeMax = atoi(argv[++i]);
+        else if (!strcmp(a, "--random") && hasValue)
+            opt.random = (size_t)strtoull(argv[++i], nullptr, 10);
+        else if (!strcmp(a, "--seed") && hasValue)
+            opt.seed = strtoull(argv[++i], nullptr, 10);
+        else if (!strcmp(a, "--scramble"))
+            opt.scramble = true;
+        else if (!strcmp(a, "--optimal"))
+            opt.optimal = true;
+        else if (!strcmp(a, "--portfolio") && hasValue)
+            opt.portfolio = (size_t)atoi(argv[++i]);
+        else if (!strcmp(a, "--budget") && hasValue)
+            opt.budget = atof(argv[++i]);
+        else if (!strcmp(a, "-h") || !strcmp(a, "--help"))
+            return false;
+        else if (a[0] == '-' && a[1] != '\0')
+            return false;
+        else
+            opt.input = a;
+    }
+    return true;
+}
+
+// 与 min2phase 的输出格式相同：转动后跟 "(Nf)"
+std::string formatSolution(const std::vector<MoveId> &moves)
+{
+    std::string out;
+    for (MoveId m : moves)
+    {
+        out += moveName(m);
+        out += ' ';
+    }
+    return out + "(" + std::to_string(moves.size()) + "f)";
+}
+
+// 最优求解，失败时与 min2phase 一样返回 "Error N"
+std::string solveOptimal(const std::string &facelets, const Options &opt)
+{
+    CubieState state;
+    if (!Solver::decodeFacelets(facelets, state))
+        return "Error 1";
+    OptimalResult result = OptimalSolver::solve(state, opt.budget > 0 ? opt.budget : 60.0, 1);
+    if (!result.solved)
+        return "Error 8";
+    return formatSolution(result.moves);
+}
+
+std::string solvePortfolio(const std::string &facelets, const Options &opt)
+{
+    CubieState state;
+    if (!Solver::decodeFacelets(facelets, state))
+        return "Error 1";
+    Cube cube;
+    cube.setState(state);
+    PortfolioOptions options;
+    options.variants = opt.portfolio;
+    if (opt.budget > 0)
+        options.budgetSeconds = opt.budget;
+    options.probeMax = opt.probeMax;
+    std::vector<MoveId> moves = Solver::solvePortfolio(cube, options);
+    if (moves.empty() && !cube.isSolved())
+        return "Error 7";
+    return formatSolution(moves);
+}
+
+Result solveOne(const std::string &facelets, const Options &opt)
+{
+    Clock::time_point t0 = Clock::now();
+    Result r;
+    // 不可能复原的输入在任何引擎开始搜索之前就报错
+    if (StateError error = validateFacelets(facelets))
+        r.solution = "Error " + std::to_string((int)error);
+    else if (opt.optimal)
+        r.solution = solveOptimal(facelets, opt);
+    else if (opt.portfolio > 0)
+        r.solution = solvePortfolio(facelets, opt);
+    else
+        r.solution = Solver::solveFacelets(facelets, opt.maxDepth, opt.probeMax);
+    // min2phase 出错时返回 "Error N"
+    r.ok = r.solution.compare(0, 5, "Error") != 0;
+    std::vector<MoveId> moves;
+    if (r.ok)
+        moves = Solver::parseSolution(r.solution);
+    r.moves = moves.size();
+    if (r.ok && opt.scramble)
+    {
+        invertMoves(moves);
+        r.solution.clear();
+        for (MoveId m : moves)
+        {
+            if (!r.solution.empty())
+                r.solution += ' ';
+            r.solution += moveName(m);
+        }
+    }
+    r.latencyUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+    return r;
+}
+
+double percentile(std::vector<double> &v, double p)
+{
+    if (v.empty())
+        return 0.0;
+    size_t k = (size_t)(p * (double)(v.size() - 1) + 0.5);
+    std::nth_element(v.begin(), v.begin() + (long)k, v.end());
+    return v[k];
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    if (!parseArgs(argc, argv, opt))
+    {
+        usage();
+        return 2;
+    }
+    std::ifstream file;
+    if (opt.input && opt.random == 0)
+    {
+        file.open(opt.input);
+        if (!file)
+        {
+            std::cerr << "rubik_batch: cannot open " << opt.input << std::endl;
+            return 1;
+        }
+    }
+    std::istream &in = opt.input ? static_cast<std::istream &>(file) : std::cin;
+    std::ios::sync_with_stdio(false);
+
+    // 建表不计入吞吐
+    if (opt.optimal)
+        OptimalSolver::ensureReady();
+    else
+        TableCache::ensureReady();
+
+    ThreadPool pool(opt.threads);
+    // 在途请求数有上限：读入、求解、按序输出三者流水进行，内存占用与输入规模无关
+    const size_t window = pool.size() * 64;
+    std::deque<std::future<Result>> inflight;
+    std::vector<double> latencies;
+    size_t solved = 0, failed = 0, totalMoves = 0;
+
+    auto drainOne = [&] {
+        Result r = inflight.front().get();
+        inflight.pop_front();
+        std::cout << r.solution << '\n';
+        latencies.push_back(r.latencyUs);
+        if (r.ok)
+        {
+            ++solved;
+            totalMoves += r.moves;
+        }
+        else
+            ++failed;
+    };
+
+    Clock::time_point start = Clock::now();
+    auto submit = [&](const std::string &facelets) {
+        inflight.push_back(pool.submit([facelets, &opt] { return solveOne(facelets, opt); }));
+        if (inflight.size() >= window)
+            drainOne();
+    };
+    if (opt.random > 0)
+    {
+        // 状态在主线程按顺序生成，与线程数无关，同一种子总是得到同一批状态
+        ScrambleRng rng(opt.seed);
+        Cube cube;
+        for (size_t i = 0; i < opt.random; ++i)
+        {
+            cube.setState(randomCubieState(rng));
+            submit(Solver::encodeFacelets(cube));
+        }
+    }
+    else
+    {
+        std::string line;
+        while (std::getline(in, line))
+        {
+            // 去掉行尾空白（兼容 CRLF）
+            while (!line.empty() && isspace((unsigned char)line.back()))
+                line.pop_back();
+            if (line.empty())
+                continue;
+            submit(line);
+        }
+    }
+    while (!inflight.empty())
+        drainOne();
+    std::cout.flush();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    size_t total = solved + failed;
+    std::cerr << "[rubik_batch] " << total << " states, " << solved << " solved, " << failed << " failed, "
+              << pool.size() << " threads\n";
+    if (total > 0)
+    {
+        char buf[256];
+        snprintf(buf, sizeof(buf),
+                 "[rubik_batch] %.1f solves/s, latency p50 %.1f us, p99 %.1f us, avg %.2f moves\n",
+                 (double)total / seconds, percentile(latencies, 0.50), percentile(latencies, 0.99),
+                 solved ? (double)totalMoves / (double)solved : 0.0);
+        std::cerr << buf;
+    }
+    return failed == 0 ? 0 : 1;
+}